@@ -1,6 +1,8 @@
+#include "./view/batch.h"
 #include "./view/console.h"
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (argc > 1) return Batch::Main(argc, argv);
   Console console;
   console.Run();
   return 0;
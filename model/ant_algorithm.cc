@@ -2,89 +2,329 @@
 
 /**
  * @brief Ant class constructor. Initializes an Ant object with the given graph
- * and starting vertex.
+ * and the storage it works in. The ant does not own the storage, which lives
+ * in the arena of its colony, and gets its start vertex from Reset.
  * @param graph A reference to a Graph object containing the graph that the ant
  * will traverse.
+ * @param path Storage for the path, room for graph.Size() + 1 vertices.
+ * @param tabu Storage for the tabu bitmask, one bit per vertex.
+ * @param candidates The number of nearest neighbors the ant chooses from, or 0
+ * to consider all vertices.
+ * @param exploitation The probability of moving along the best edge instead of
+ * roulette selection (q0 of Ant Colony System).
+ */
+Ant::Ant(const Graph &graph, int *path, uint64_t *tabu, size_t candidates,
+         double exploitation)
+    : graph_{graph},
+      path_{path},
+      path_size_{0},
+      tabu_{tabu},
+      chances_{Chances(std::min(candidates, graph.Size()))},
+      candidates_{candidates},
+      exploitation_{exploitation},
+      distance_{0.0},
+      steps_{0},
+      dead_end_{false} {}
+
+/**
+ * @brief Prepares the ant for a new bypass in place, without allocations.
+ *
  * @param start The index of the starting vertex for the ant's path.
+ * @param seed The seed of the ant's own random generator.
  */
-Ant::Ant(const Graph &graph, size_t start)
-    : graph_{graph}, tabu_{Tabu(graph.GetGraph().size())} {
-  path_.push_back(start);
-  tabu_[start] = true;
+void Ant::Reset(size_t start, uint64_t seed) {
+  std::fill_n(tabu_, (graph_.Size() + 63) / 64, 0);
+  random_ = Random(seed);
+  distance_ = 0.0;
+  path_[0] = start;
+  path_size_ = 1;
+  Visit(start);
 }
 
 /**
- * @brief Simulates one pass through all vertices in the graph using pheromones
- * to choose the next path.
+ * @brief Simulates one pass through all vertices in the graph using the
+ * choice info to choose the next path. The tour length is accumulated along
+ * the way. The pass does no heap allocations. If there is no edge back to the
+ * start vertex, the path is left open and the tour is incomplete.
  *
- * @param pheromones A reference to the Pheromones object containing pheromone
- * values.
+ * @param choice_info A reference to the matrix of pheromone and visibility
+ * products.
  */
-void Ant::MakeBypass(const Pheromones &pheromones) {
-  for (size_t i = 0; i < graph_.GetGraph().size(); ++i) {
-    int next = ChooseNextPath(pheromones, path_.back());
-    if (next != -1) {
-      visited_.emplace_back(path_.back(), next);
-      path_.push_back(next);
-      tabu_[next] = true;
-    }
+void Ant::MakeBypass(const ChoiceInfo &choice_info) {
+  distance_ = 0.0;
+  int current = path_[0];
+  while (path_size_ < graph_.Size()) {
+    int next = ChooseNextPath(choice_info, current);
+    if (next == -1) break;
+    distance_ += graph_.GetWeightUnchecked(current, next);
+    path_[path_size_++] = next;
+    Visit(next);
+    current = next;
+  }
+  ANT_STATS_ONLY(dead_end_ = path_size_ < graph_.Size();
+                 steps_ = path_size_ - 1 + dead_end_;)
+  if (path_size_ == graph_.Size() and path_size_ > 1 and
+      !graph_.HasEdge(current, path_[0])) {
+    return;
+  }
+  distance_ += graph_.GetWeightUnchecked(current, path_[0]);
+  path_[path_size_++] = path_[0];
+}
+
+/**
+ * @brief Shortens the ant's path with local search.
+ *
+ * @param search The local search object of the calling thread.
+ * @param method Neighborhoods to search.
+ * @return True if the path has been shortened.
+ */
+bool Ant::ImprovePath(LocalSearch &search, LocalSearchMethod method) {
+  if (!search.Improve(path_, path_size_, method)) return false;
+  ComputeDistance();
+  return true;
+}
+
+/**
+ * @brief Computes the total distance traveled by an ant along its path.
+ *
+ */
+void Ant::ComputeDistance() {
+  distance_ = 0.0;
+  for (size_t i = 1; i < path_size_; ++i) {
+    distance_ += graph_.GetWeightUnchecked(path_[i - 1], path_[i]);
   }
-  path_.push_back(path_.front());
 }
 
 /**
- * @brief Chooses the next path for an ant to travel on based on the provided
- * pheromone levels and the current path.
+ * @brief Chooses the next path for an ant to travel on by roulette selection
+ * over the unvisited neighbors of the current vertex. With the exploitation
+ * probability the ant takes the best edge instead.
  *
- * @param pheromones The pheromone levels for each path in the graph.
+ * @param choice_info The pheromone and visibility products of the graph edges.
  * @param path The index of the current vertex in the graph.
  *
  * @return the index of the next path to be taken, or -1 if no path is
  * available.
  */
-int Ant::ChooseNextPath(const Pheromones &pheromones, size_t path) {
-  const Chances chances = GetChances(pheromones, path);
-  const double rnd = RandomChoice(0.0, 1.0);
-  for (size_t i = 1; i < chances.size(); ++i) {
-    if (!tabu_[i - 1] and rnd < chances[i]) return i - 1;
+int Ant::ChooseNextPath(const ChoiceInfo &choice_info, size_t path) {
+  if (exploitation_ > 0.0 and RandomChoice(0.0, 1.0) < exploitation_) {
+    return ChooseBest(choice_info, path);
   }
-  return -1;
+  if (candidates_) return ChooseCandidate(choice_info, path);
+  if (graph_.HasCompressedRows()) return ChooseNeighbor(choice_info, path);
+  const RowKernels &kernels = GetRowKernels();
+  const double *row = choice_info.Row(path);
+  const double total = kernels.sum(row, tabu_, graph_.Size());
+  if (total <= 0.0) return -1;
+  const double target = RandomChoice(0.0, 1.0) * total;
+  return kernels.select(row, tabu_, graph_.Size(), target);
 }
 
 /**
- * @brief Calculates the probability of each unvisited neighbor vertex for an
- * ant to move to from the current vertex.
+ * @brief Chooses the next path by roulette selection over the edges of the
+ * current vertex in compressed rows, whose choice info is stored per edge.
+ * In a sparse graph only existing edges are visited, so a dead end is
+ * detected in time proportional to the degree of the vertex. In a coordinate
+ * graph the rows hold the candidate edges; once all candidates are visited,
+ * the ant moves to a near unvisited vertex.
  *
- * @param pheromones The pheromone levels for each path in the graph.
+ * @param choice_info The pheromone and visibility products of the graph edges.
  * @param path The index of the current vertex in the graph.
  *
- * @return A vector representing the cumulative sum of probabilities of moving
- * to each unvisited neighbor vertex.
+ * @return the index of the next path to be taken, or -1 if no path is
+ * available.
  */
-Ant::Chances Ant::GetChances(const Pheromones &pheromones, size_t path) {
-  const auto &graph = graph_.GetGraph();
-  Chances chances(graph.size(), std::numeric_limits<double>::infinity());
+int Ant::ChooseNeighbor(const ChoiceInfo &choice_info, size_t path) {
+  const double *row = choice_info.Data() + graph_.GetNeighborOffset(path);
+  const int *neighbors = graph_.GetNeighbors(path);
+  const size_t count = graph_.GetNeighborCount(path);
+
   double total = 0.0;
+  for (size_t k = 0; k < count; ++k) {
+    if (!IsVisited(neighbors[k])) total += row[k];
+  }
+  if (total <= 0.0) return graph_.HasCoordinates() ? ChooseNearest(path) : -1;
+  const double target = RandomChoice(0.0, 1.0) * total;
+  double cumulate = 0.0;
+  int last = -1;
+  for (size_t k = 0; k < count; ++k) {
+    if (!IsVisited(neighbors[k]) and row[k] > 0.0) {
+      cumulate += row[k];
+      last = neighbors[k];
+      if (target < cumulate) break;
+    }
+  }
+  return last;
+}
+
+/**
+ * @brief Chooses the next path among the unvisited nearest neighbors of the
+ * current vertex. When all of them are visited, the ant moves to the best
+ * remaining vertex by choice info.
+ *
+ * @param choice_info The pheromone and visibility products of the graph edges.
+ * @param path The index of the current vertex in the graph.
+ *
+ * @return the index of the next path to be taken, or -1 if no path is
+ * available.
+ */
+int Ant::ChooseCandidate(const ChoiceInfo &choice_info, size_t path) {
+  const int *candidates = graph_.GetCandidates(path);
+  const int *columns = CandidateColumns(path);
+  const double *row = ChoiceRow(choice_info, path);
+  const size_t count = std::min(candidates_, graph_.GetCandidateCount(path));
 
-  for (size_t i = 0; i < graph.size(); ++i) {
-    if (graph[path][i] and !tabu_[i]) {
-      chances[i] = std::pow(pheromones[path][i], consts_.kAlpha) *
-                   std::pow(1.0 / graph[path][i], consts_.kBeta);
-      total += chances[i];
+  double total = 0.0;
+  for (size_t k = 0; k < count; ++k) {
+    chances_[k] = IsVisited(candidates[k]) ? 0.0 : row[columns[k]];
+    total += chances_[k];
+  }
+  if (total > 0.0) {
+    const double target = RandomChoice(0.0, 1.0) * total;
+    double cumulate = 0.0;
+    int last = -1;
+    for (size_t k = 0; k < count; ++k) {
+      if (chances_[k] > 0.0) {
+        cumulate += chances_[k];
+        last = candidates[k];
+        if (target < cumulate) break;
+      }
     }
+    return last;
   }
+  return ChooseBest(choice_info, path);
+}
 
-  std::transform(chances.begin(), chances.end(), chances.begin(),
-                 [total](double chance) {
-                   return !std::isinf(chance) ? chance / total : 0;
-                 });
+/**
+ * @brief Chooses the unvisited vertex with the largest choice info, looking at
+ * the candidate list first when it is enabled.
+ *
+ * @param choice_info The pheromone and visibility products of the graph edges.
+ * @param path The index of the current vertex in the graph.
+ *
+ * @return the index of the next path to be taken, or -1 if no path is
+ * available.
+ */
+int Ant::ChooseBest(const ChoiceInfo &choice_info, size_t path) {
+  const double *row = ChoiceRow(choice_info, path);
+  int best = -1;
+  double best_chance = 0.0;
+  if (candidates_) {
+    const int *candidates = graph_.GetCandidates(path);
+    const int *columns = CandidateColumns(path);
+    const size_t count = std::min(candidates_, graph_.GetCandidateCount(path));
+    for (size_t k = 0; k < count; ++k) {
+      if (!IsVisited(candidates[k]) and row[columns[k]] > best_chance) {
+        best_chance = row[columns[k]];
+        best = candidates[k];
+      }
+    }
+    if (best != -1) return best;
+  }
+  if (graph_.HasCompressedRows()) {
+    const int *neighbors = graph_.GetNeighbors(path);
+    const double *edges = choice_info.Data() + graph_.GetNeighborOffset(path);
+    for (size_t k = 0; k < graph_.GetNeighborCount(path); ++k) {
+      if (!IsVisited(neighbors[k]) and edges[k] > best_chance) {
+        best_chance = edges[k];
+        best = neighbors[k];
+      }
+    }
+    if (best == -1 and graph_.HasCoordinates()) return ChooseNearest(path);
+    return best;
+  }
+  for (size_t i = 0; i < graph_.Size(); ++i) {
+    if (!IsVisited(i) and row[i] > best_chance) {
+      best_chance = row[i];
+      best = i;
+    }
+  }
+  return best;
+}
 
-  Chances cumulate(chances.size() + 1);
-  std::partial_sum(chances.begin(), chances.end(), cumulate.begin() + 1);
+/**
+ * @brief Chooses a near unvisited vertex of a coordinate graph, for moves off
+ * the candidate edges: the nearest unvisited candidate of a candidate of the
+ * current vertex, or else the nearest unvisited vertex overall. The full scan
+ * skips words of the tabu bitmask with every vertex visited.
+ *
+ * @param path The index of the current vertex in the graph.
+ *
+ * @return the index of the next path to be taken, or -1 if every vertex is
+ * visited.
+ */
+int Ant::ChooseNearest(size_t path) const {
+  int best = -1;
+  int best_weight = 0;
+  const auto consider = [this, path, &best, &best_weight](size_t vertex) {
+    const int weight = graph_.GetWeightUnchecked(path, vertex);
+    if (best == -1 or weight < best_weight) {
+      best = vertex;
+      best_weight = weight;
+    }
+  };
+  const int *neighbors = graph_.GetNeighbors(path);
+  for (size_t k = 0; k < graph_.GetNeighborCount(path); ++k) {
+    const int *second = graph_.GetNeighbors(neighbors[k]);
+    for (size_t l = 0; l < graph_.GetNeighborCount(neighbors[k]); ++l) {
+      if (!IsVisited(second[l])) consider(second[l]);
+    }
+  }
+  if (best != -1) return best;
+
+  const size_t vertex_cnt = graph_.Size();
+  for (size_t word = 0; word * 64 < vertex_cnt; ++word) {
+    for (uint64_t free = ~tabu_[word]; free; free &= free - 1) {
+      const size_t vertex = word * 64 + __builtin_ctzll(free);
+      if (vertex >= vertex_cnt) break;
+      consider(vertex);
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Returns the choice info that candidate columns index: the row of
+ * the current vertex of a dense graph, or all edges in compressed rows.
+ *
+ * @param choice_info The pheromone and visibility products of the graph edges.
+ * @param path The index of the current vertex in the graph.
+ * @return const double*
+ */
+const double *Ant::ChoiceRow(const ChoiceInfo &choice_info, size_t path) const {
+  return graph_.HasCompressedRows() ? choice_info.Data()
+                                   : choice_info.Row(path);
+}
 
-  return cumulate;
+/**
+ * @brief Returns the positions of the candidates of a vertex in its choice
+ * row: the candidates themselves, or their edge indices in compressed rows.
+ *
+ * @param path The index of the current vertex in the graph.
+ * @return const int*
+ */
+const int *Ant::CandidateColumns(size_t path) const {
+  return graph_.HasCompressedRows() ? graph_.GetCandidateEdges(path)
+                                   : graph_.GetCandidates(path);
 }
 
+/**
+ * @brief Checks the bit of a vertex in the tabu bitmask.
+ *
+ * @param vertex
+ * @return True if the ant has already visited the vertex.
+ */
+bool Ant::IsVisited(size_t vertex) const {
+  return (tabu_[vertex >> 6] >> (vertex & 63)) & 1;
+}
+
+/**
+ * @brief Sets the bit of a vertex in the tabu bitmask.
+ *
+ * @param vertex
+ */
+void Ant::Visit(size_t vertex) { tabu_[vertex >> 6] |= 1ULL << (vertex & 63); }
+
 /**
  * @brief Returns a random double value within the given range [min, max].
  *
@@ -93,159 +333,1113 @@ Ant::Chances Ant::GetChances(const Pheromones &pheromones, size_t path) {
  * @return A random double value
  */
 double Ant::RandomChoice(const double min, const double max) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_real_distribution<double> dist(min, max);
-  return dist(gen);
+  return min + (max - min) * random_.NextDouble();
 }
 
 /**
- * @brief Computes the total distance traveled by an ant along its current path.
+ * @brief Returns the total distance traveled by an ant along its path. The
+ * distance is computed once at the end of the bypass and after local search.
  *
  * @return A double value representing the total distance traveled by the ant.
  */
-double Ant::GetDistance() const {
-  double distance = 0.0;
-  for (size_t i = 1; i < path_.size(); ++i) {
-    distance += graph_.GetWeight(path_[i - 1], path_[i]);
-  }
-  return distance;
-}
+double Ant::GetDistance() const { return distance_; }
 
 /**
- * @brief Returns the path followed by an ant.
+ * @brief Checks whether the ant has visited every vertex of the graph.
  *
- * @return The path member.
+ * @return True if the path is a closed tour through all vertices.
  */
-Ant::Path Ant::GetPath() const { return path_; }
+bool Ant::IsComplete() const { return path_size_ == graph_.Size() + 1; }
 
 /**
- * @brief Checks if a given vertex has already been visited by the ant.
+ * @brief Returns the path followed by an ant, the start vertex repeated at
+ * the end.
  *
- * @param i The row index of the cell to check.
- * @param j The column index of the cell to check.
- * @return True if the vertex has already been visited, false otherwise.
+ * @return Pointer to the first vertex of the path.
  */
-bool Ant::IsVisited(size_t i, size_t j) const {
-  return std::any_of(visited_.cbegin(), visited_.cend(),
-                     [i, j](std::pair<size_t, size_t> v) {
-                       return v.first == i and v.second == j;
-                     });
-}
+const int *Ant::GetPath() const { return path_; }
+
+/**
+ * @brief Returns the number of vertices in the path followed by an ant.
+ *
+ * @return size_t
+ */
+size_t Ant::GetPathSize() const { return path_size_; }
+
+/**
+ * @brief Returns the number of next vertex choices made in the last bypass.
+ * Counted only with ANT_STATS.
+ *
+ * @return size_t
+ */
+size_t Ant::GetSteps() const { return steps_; }
+
+/**
+ * @brief Checks whether the last bypass ended at a vertex with no unvisited
+ * neighbor. Counted only with ANT_STATS.
+ *
+ * @return bool
+ */
+bool Ant::HasDeadEnd() const { return dead_end_; }
 
 /**
  * @brief Constructs an AntAlgorithm object with the given graph.
  *
  * @param graph A reference to the graph on which the ant algorithm is to be
  * performed.
+ * @param pool Worker pool shared with other users. If it is null, the
+ * algorithm creates its own pool on the first parallel run.
  */
-AntAlgorithm::AntAlgorithm(const Graph &graph)
-    : graph_{graph}, parallel_{false} {}
+AntAlgorithm::AntAlgorithm(const Graph &graph, std::shared_ptr<ThreadPool> pool)
+    : graph_{graph},
+      initial_tau_{0.0},
+      pool_{std::move(pool)},
+      random_{std::random_device{}()},
+      choice_kernel_{nullptr},
+      parallelism_{Parallelism::kNone},
+      stop_{false},
+      bypasses_{0} {}
 
 /**
- * @brief Runs the ant colony optimization algorithm on loaded graph.
+ * @brief Runs the ant colony optimization algorithm on loaded graph. Colony
+ * seeds are drawn up front, so the result for a given seed does not depend on
+ * the parallelism mode, except with Ant Colony System, whose local update is
+ * deferred when ants run in parallel.
+ *
+ * The run ends early, with the best tour found so far, once a tour of the
+ * target length is found or the time limit is over. Both are checked after
+ * every bypass, so every started colony makes at least one bypass, and
+ * results of a run stopped this way depend on timing.
+ *
+ * If bound iterations are set, the Held-Karp lower bound is computed as a
+ * second task on the pool while the ants run, and the run also ends once the
+ * best tour is within the configured gap of the bound. If no pool thread is
+ * free before the ants finish, the bound is computed after them, uncancelled,
+ * so it is still reported.
+ *
+ * Graphs of at most exact_size vertices are solved exactly instead.
+ *
+ * With ANT_STATS, the run also collects the timings and counters returned
+ * by GetStats.
  *
  */
 void AntAlgorithm::RunAlgorithm() {
+#ifdef ANT_STATS
+  stats_ = AlgorithmStats();
+  const std::vector<double> busy =
+      pool_ ? pool_->GetBusyTimes() : std::vector<double>();
+  {
+    PhaseTimer timer(stats_.total_time);
+    Solve();
+  }
+  CollectThreadStats(busy);
+#else
+  Solve();
+#endif
+}
+
+/**
+ * @brief Solves the loaded graph exactly or with the colonies, alongside the
+ * lower bound if it is enabled.
+ *
+ */
+void AntAlgorithm::Solve() {
+  bypasses_ = 0;
+  if (graph_.Size() >= 2 and graph_.Size() <= consts_.exact_size) {
+    SolveExactly();
+    return;
+  }
+  stop_ = false;
+  deadline_ = std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(consts_.time_limit));
+  InitVisibility();
+  InitTau();
+  choice_kernel_ = SelectChoiceKernel(consts_.alpha);
+  colony_.ants.clear();
+  std::vector<uint64_t> seeds(consts_.colonies);
+  for (auto &seed : seeds) {
+    seed = random_();
+  }
+  if (!consts_.bound_iterations) {
+    RunSearch(seeds);
+    return;
+  }
+
+  bound_ = std::make_unique<LowerBound>(graph_);
+  std::atomic<bool> bounding{false};
+  const ThreadPool::Body tasks = [this, &seeds, &bounding](size_t begin,
+                                                           size_t end) {
+    for (size_t task = begin; task < end; ++task) {
+      if (task == 1) {
+        bounding = true;
+        bound_->Run(consts_.bound_iterations);
+        continue;
+      }
+      try {
+        RunSearch(seeds);
+      } catch (...) {
+        bound_->Cancel();
+        throw;
+      }
+      if (bounding) bound_->Cancel();
+    }
+  };
+  try {
+    GetPool().ParallelFor(2, tasks, 1);
+  } catch (...) {
+    bound_.reset();
+    throw;
+  }
+  if (!result_.vertices.empty()) {
+    bound_->SetUpperBound(result_.distance);
+    result_.lower_bound = bound_->Get();
+    result_.gap = bound_->Gap();
+  }
+  bound_.reset();
+}
+
+/**
+ * @brief Finds an optimal tour with the exact solver, which uses the pool
+ * for large layers in every parallel mode. The result is its own lower
+ * bound, with zero gap.
+ *
+ */
+void AntAlgorithm::SolveExactly() {
+  ExactSolver solver(graph_);
+  result_ = TsmResult{Path{}, std::numeric_limits<double>::infinity()};
+  if (!solver.Solve(parallelism_ == Parallelism::kNone ? nullptr
+                                                       : &GetPool())) {
+    return;
+  }
+  result_.vertices = solver.GetPath();
+  result_.distance = solver.GetDistance();
+  result_.lower_bound = result_.distance;
+  result_.gap = 0.0;
+}
+
+/**
+ * @brief Runs the colonies in the configured parallelism mode.
+ *
+ * @param seeds The seeds of the colonies.
+ */
+void AntAlgorithm::RunSearch(const std::vector<uint64_t> &seeds) {
+  if (parallelism_ == Parallelism::kColonies) {
+    RunColoniesParallel(seeds);
+  } else if (parallelism_ == Parallelism::kIslands) {
+    RunIslands(seeds);
+  } else {
+    RunColonies(seeds);
+  }
+}
+
+/**
+ * @brief Runs independent colonies one after another.
+ *
+ * @param seeds The seeds of the colonies.
+ */
+void AntAlgorithm::RunColonies(const std::vector<uint64_t> &seeds) {
   TsmResult best_result{Path{}, std::numeric_limits<double>::infinity()};
-  for (size_t colony = 0; colony < consts_.kColonies; ++colony) {
-    RunColony();
-    if (result_.distance < best_result.distance) {
-      best_result = std::move(result_);
+  for (const uint64_t seed : seeds) {
+    RunColony(colony_, seed);
+    if (colony_.result.distance < best_result.distance) {
+      best_result = std::move(colony_.result);
     }
+    if (IsStopped()) break;
   }
   result_ = std::move(best_result);
 }
 
 /**
- * @brief Simulates pass of the graph by colony of ants.
+ * @brief Runs independent colonies concurrently. Each worker owns one colony
+ * state (pheromones, choice info and ants) and runs its share of colonies
+ * with sequential ants; the results are reduced to the global best in colony
+ * order.
  *
+ * @param seeds The seeds of the colonies.
  */
-void AntAlgorithm::RunColony() {
-  result_ = TsmResult{Path{}, std::numeric_limits<double>::infinity()};
-  pheromones_ =
-      Pheromones(graph_.GetGraph().size(),
-                 std::vector<double>(graph_.GetGraph().size(), consts_.kTau));
+void AntAlgorithm::RunColoniesParallel(const std::vector<uint64_t> &seeds) {
+  ThreadPool &pool = GetPool();
+  std::vector<TsmResult> results(
+      seeds.size(),
+      TsmResult{Path{}, std::numeric_limits<double>::infinity()});
+  const size_t grain = (seeds.size() + pool.Size() - 1) / pool.Size();
+  pool.ParallelFor(
+      seeds.size(),
+      [this, &seeds, &results](size_t begin, size_t end) {
+        Colony colony;
+        for (size_t i = begin; i < end; ++i) {
+          RunColony(colony, seeds[i]);
+          results[i] = std::move(colony.result);
+          if (IsStopped()) break;
+        }
+      },
+      grain);
 
-  for (size_t i = 0; i < consts_.kBypassCount; ++i) {
-    parallel_ ? RunAntsParallel() : RunAnts();
-    UpdateResult();
-    UpdatePheromones();
+  TsmResult best_result{Path{}, std::numeric_limits<double>::infinity()};
+  for (auto &result : results) {
+    if (result.distance < best_result.distance) {
+      best_result = std::move(result);
+    }
   }
+  result_ = std::move(best_result);
 }
 
 /**
- * @brief Simulates pass of the graph by each ant of a colony.
+ * @brief Runs colonies as islands: every island runs its share of colonies on
+ * its own thread, and every migration interval it publishes its best tour to
+ * its mailbox and takes the tour from the previous island's mailbox if it is
+ * better, reinforcing it in its own pheromones. Mailboxes are exchanged with
+ * std::atomic_load and std::atomic_store on shared pointers, which lock a
+ * mutex only for the pointer copy, so islands wait for each other at most
+ * that long and never for a migration; the price is that results depend on
+ * thread timing and are not reproducible from the seed.
  *
+ * @param seeds The seeds of the colonies.
  */
-void AntAlgorithm::RunAnts() {
-  ants_ = Ants(graph_.GetGraph().size());
-  for (size_t i = 0; i < ants_.size(); ++i) {
-    ants_[i] = std::make_unique<Ant>(graph_, i);
-    ants_[i]->MakeBypass(pheromones_);
+void AntAlgorithm::RunIslands(const std::vector<uint64_t> &seeds) {
+  ThreadPool &pool = GetPool();
+  const size_t islands =
+      std::min(consts_.islands ? consts_.islands : pool.Size(), seeds.size());
+  std::vector<Mailbox> mailboxes(islands);
+  std::vector<TsmResult> results(
+      seeds.size(),
+      TsmResult{Path{}, std::numeric_limits<double>::infinity()});
+  pool.ParallelFor(
+      islands,
+      [&](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+          Colony colony;
+          Island island{&mailboxes, index};
+          for (size_t i = index * seeds.size() / islands;
+               i < (index + 1) * seeds.size() / islands; ++i) {
+            RunColony(colony, seeds[i], &island);
+            results[i] = std::move(colony.result);
+            if (IsStopped()) break;
+          }
+        }
+      },
+      1);
+
+  TsmResult best_result{Path{}, std::numeric_limits<double>::infinity()};
+  for (auto &result : results) {
+    if (result.distance < best_result.distance) {
+      best_result = std::move(result);
+    }
   }
+  result_ = std::move(best_result);
 }
 
 /**
- * @brief Simulates parallel pass of the graph by each ant of a colony.
+ * @brief Exchanges the best tours between an island and its neighbor.
+ *
+ * @param colony The colony currently running on the island.
+ * @param island The island.
+ */
+void AntAlgorithm::Migrate(Colony &colony, Island &island) {
+  auto &mailboxes = *island.mailboxes;
+  Mailbox own = std::atomic_load(&mailboxes[island.index]);
+  if (!colony.result.vertices.empty() and
+      (!own or colony.result.distance < own->distance)) {
+    std::atomic_store(&mailboxes[island.index],
+                      Mailbox(std::make_shared<TsmResult>(colony.result)));
+  }
+
+  const size_t from = (island.index + mailboxes.size() - 1) % mailboxes.size();
+  Mailbox migrant = std::atomic_load(&mailboxes[from]);
+  if (migrant and migrant->distance < colony.result.distance) {
+    colony.result = *migrant;
+    Deposit(colony.pheromones, migrant->vertices.data(),
+            migrant->vertices.size(), migrant->distance);
+  }
+}
+
+/**
+ * @brief Simulates pass of the graph by colony of ants. The colony stops
+ * before its last bypass if it stagnates or converges, or if the whole run is
+ * stopped.
  *
+ * @param colony The state of the colony, reset before the first bypass.
+ * @param seed The seed of the colony.
+ * @param island The island the colony runs on, if any.
  */
-void AntAlgorithm::RunAntsParallel() {
-  ants_.clear();
-  Threads threads;
-  for (size_t i = 0; i < graph_.GetGraph().size(); ++i) {
-    threads.emplace_back(&AntAlgorithm::ParallelBypass, this, i);
+void AntAlgorithm::RunColony(Colony &colony, uint64_t seed, Island *island) {
+  colony.result = TsmResult{Path{}, std::numeric_limits<double>::infinity()};
+  colony.random = Random(seed);
+  colony.bypass = 0;
+  const auto [rows, cols] = EdgeShape();
+  if (colony.pheromones.Rows() != rows or colony.pheromones.Cols() != cols) {
+    colony.pheromones = Pheromones(rows, cols);
   }
-  for (auto &thread : threads) {
-    thread.join();
+  colony.pheromones.Fill(initial_tau_);
+  ANT_STATS_ONLY(++colony.stats.colonies);
+  ANT_TIMED(colony.stats.choice_info_time, UpdateChoiceInfo(colony));
+  if (colony.ants.size() != AntCount()) CreateAnts(colony);
+
+  size_t last_improvement = 0;
+  for (size_t i = 0; i < consts_.bypass_count; ++i) {
+    colony.bypass_seed = colony.random();
+    ANT_TIMED(colony.stats.construction_time,
+              parallelism_ == Parallelism::kAnts ? RunAntsParallel(colony)
+                                                 : RunAnts(colony));
+    ++bypasses_;
+    ANT_STATS_ONLY(CountBypass(colony));
+    ANT_TIMED(colony.stats.improvement_time, ImproveTours(colony));
+    const double previous = colony.result.distance;
+    ANT_TIMED(colony.stats.result_time, UpdateResult(colony));
+    if (colony.result.distance < previous) {
+      last_improvement = i;
+      ANT_STATS_ONLY(++colony.stats.improvements);
+    }
+    ANT_TIMED(colony.stats.pheromone_time, UpdatePheromones(colony));
+    if (island and (i + 1) % consts_.migration_interval == 0) {
+      Migrate(colony, *island);
+    }
+    if (IsStopped() or HasConverged(colony, i - last_improvement)) break;
+    ANT_TIMED(colony.stats.choice_info_time, UpdateChoiceInfo(colony));
   }
+  ANT_STATS_ONLY(MergeStats(colony));
 }
 
 /**
- * @brief Executes the Ant's MakeBypass method in parallel for a given vertex.
+ * @brief Adds the bypass just made by the ants of a colony to its counters.
  *
- * @param vertex The start vertex for the ants' bypass.
+ * @param colony The colony.
  */
-void AntAlgorithm::ParallelBypass(const size_t vertex) {
-  auto ant = std::make_unique<Ant>(graph_, vertex);
-  ant->MakeBypass(pheromones_);
+void AntAlgorithm::CountBypass(Colony &colony) {
+  ++colony.stats.bypasses;
+  for (const auto &ant : colony.ants) {
+    colony.stats.steps += ant.GetSteps();
+    colony.stats.dead_ends += ant.HasDeadEnd();
+  }
+}
 
-  std::lock_guard<std::mutex> lock(mtx_);
-  ants_.emplace_back(std::move(ant));
+/**
+ * @brief Adds the counters of a finished colony to the counters of the run
+ * and clears them. Colonies may finish concurrently.
+ *
+ * @param colony The colony.
+ */
+void AntAlgorithm::MergeStats(Colony &colony) {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  stats_.Merge(colony.stats);
+  colony.stats = AlgorithmStats();
+}
+
+/**
+ * @brief Fills the busy and idle times of the threads of the run. A serial
+ * run keeps its only thread busy all the time; in parallel runs a thread is
+ * busy while it executes parallel loop bodies. The pool counters are never
+ * reset, since the pool may be shared; the run takes their growth since it
+ * started. That growth includes the loops of every caller of the pool, so
+ * the times are only meaningful on a pool the algorithm uses alone.
+ *
+ * @param before The busy times of the pool when the run started, empty if
+ * the pool did not exist yet.
+ */
+void AntAlgorithm::CollectThreadStats(const std::vector<double> &before) {
+  if (parallelism_ == Parallelism::kNone or !pool_) {
+    stats_.thread_busy.assign(1, stats_.total_time);
+    stats_.thread_idle.assign(1, 0.0);
+    return;
+  }
+  stats_.thread_busy = pool_->GetBusyTimes();
+  stats_.thread_idle.resize(stats_.thread_busy.size());
+  for (size_t i = 0; i < stats_.thread_busy.size(); ++i) {
+    if (i < before.size()) stats_.thread_busy[i] -= before[i];
+    stats_.thread_idle[i] =
+        std::max(0.0, stats_.total_time - stats_.thread_busy[i]);
+  }
 }
 
 /**
- * @brief Updates pheromone levels on all paths based on ant tours.
+ * @brief Computes visibility of every edge raised to the power of beta.
+ * Missing edges get zero visibility, so ants never choose them. Points of a
+ * coordinate graph less than half a unit apart have zero rounded distance;
+ * their edges get the visibility of distance kMinDistance. Sparse and
+ * coordinate graphs keep visibility on the edges of their compressed rows,
+ * all edges of a sparse graph or the candidate edges of a coordinate graph;
+ * matrix graphs get a dense n x n matrix.
  *
  */
-void AntAlgorithm::UpdatePheromones() {
-  const size_t vertex_cnt = graph_.GetGraph().size();
+void AntAlgorithm::InitVisibility() {
+  const size_t vertex_cnt = graph_.Size();
+  const VisibilityKernel kernel = SelectVisibilityKernel(consts_.beta);
+  if (graph_.HasCompressedRows()) {
+    const size_t edges = graph_.GetEdgeCount();
+    const int *weights = graph_.GetNeighborWeights(0);
+    visibility_ = ChoiceInfo(1, edges);
+    kernel(weights, visibility_.Row(0), edges, consts_.beta);
+    if (graph_.HasCoordinates()) {
+      const double nearest = std::pow(1.0 / kMinDistance, consts_.beta);
+      for (size_t edge = 0; edge < edges; ++edge) {
+        if (!weights[edge]) visibility_(0, edge) = nearest;
+      }
+    }
+    return;
+  }
+  visibility_ = ChoiceInfo(vertex_cnt, vertex_cnt);
+  std::vector<int> weights(vertex_cnt);
   for (size_t i = 0; i < vertex_cnt; ++i) {
-    for (size_t j = i + 1; j < vertex_cnt; ++j) {
-      for (const auto &ant : ants_) {
-        if (ant->IsVisited(i, j)) {
-          pheromones_[i][j] += (1.0 - consts_.kRo) * pheromones_[i][j] +
-                               consts_.kQ / ant->GetDistance();
-          pheromones_[j][i] = pheromones_[i][j];
+    graph_.GetWeightRow(i, weights.data());
+    kernel(weights.data(), visibility_.Row(i), vertex_cnt, consts_.beta);
+    visibility_(i, i) = 0.0;
+  }
+}
+
+/**
+ * @brief Chooses the initial pheromone level. MAX-MIN Ant System starts at
+ * the upper bound q / (ro * L) and Ant Colony System at q / (n * L), where L
+ * is the length of a nearest neighbor tour; the classic rule starts at tau.
+ * Candidate lists are sorted by weight, then by vertex index, so the first
+ * unvisited candidate is the nearest vertex and the full scan is only made
+ * when every candidate is visited.
+ *
+ */
+void AntAlgorithm::InitTau() {
+  initial_tau_ = consts_.tau;
+  if (consts_.update == PheromoneUpdate::kClassic) return;
+
+  const size_t vertex_cnt = graph_.Size();
+  std::vector<bool> visited(vertex_cnt);
+  size_t current = 0;
+  double length = 0.0;
+  visited[current] = true;
+  for (size_t step = 1; step < vertex_cnt; ++step) {
+    int next = -1;
+    int next_weight = 0;
+    const auto consider = [&](int vertex, int weight) {
+      if (!visited[vertex] and (next == -1 or weight < next_weight)) {
+        next = vertex;
+        next_weight = weight;
+      }
+    };
+    const int *candidates = graph_.GetCandidates(current);
+    const int *candidate_weights = graph_.GetCandidateWeights(current);
+    for (size_t k = 0; next == -1 and k < graph_.GetCandidateCount(current);
+         ++k) {
+      consider(candidates[k], candidate_weights[k]);
+    }
+    if (next == -1 and graph_.IsSparse()) {
+      const int *neighbors = graph_.GetNeighbors(current);
+      const int *weights = graph_.GetNeighborWeights(current);
+      for (size_t k = 0; k < graph_.GetNeighborCount(current); ++k) {
+        consider(neighbors[k], weights[k]);
+      }
+    } else if (next == -1) {
+      for (size_t i = 0; i < vertex_cnt; ++i) {
+        if (graph_.HasEdge(current, i)) {
+          consider(i, graph_.GetWeightUnchecked(current, i));
         }
       }
     }
+    if (next == -1) return;
+    length += next_weight;
+    visited[next] = true;
+    current = next;
   }
+  length += graph_.GetWeightUnchecked(current, 0);
+  if (length <= 0.0) return;
+
+  initial_tau_ = consts_.update == PheromoneUpdate::kMaxMin
+                     ? consts_.q / (consts_.ro * length)
+                     : consts_.q / (vertex_cnt * length);
 }
 
 /**
- * @brief Updates the current best TSP path found by the ant algorithm.
+ * @brief Recomputes the products of pheromone raised to the power of alpha
+ * and visibility, which ants use to choose their next vertex. The row kernel
+ * is chosen once per run, so common integer alphas avoid std::pow.
  *
+ * @param colony The colony whose choice info is updated.
  */
-void AntAlgorithm::UpdateResult() {
-  std::sort(ants_.begin(), ants_.end(), [](auto &x, auto &y) {
-    return x->GetDistance() < y->GetDistance();
+void AntAlgorithm::UpdateChoiceInfo(Colony &colony) {
+  const auto [rows, cols] = EdgeShape();
+  if (colony.choice_info.Rows() != rows or colony.choice_info.Cols() != cols) {
+    colony.choice_info = ChoiceInfo(rows, cols);
+  }
+  ForEachEdgeBlock([this, &colony](size_t row, size_t begin, size_t end) {
+    choice_kernel_(colony.pheromones.Row(row) + begin,
+                   visibility_.Row(row) + begin,
+                   colony.choice_info.Row(row) + begin, end - begin,
+                   consts_.alpha);
   });
-  const auto &path = ants_.front();
-  TsmResult result{path->GetPath(), path->GetDistance()};
-  if (result.distance < result_.distance) {
-    result_ = std::move(result);
+}
+
+/**
+ * @brief Returns the shape of the per-edge matrices (pheromones, visibility
+ * and choice info): n x n for matrix graphs, or a single row with one value
+ * per edge, in the order of the compressed rows, for sparse and coordinate
+ * graphs.
+ *
+ * @return std::pair<size_t, size_t> Rows and columns.
+ */
+std::pair<size_t, size_t> AntAlgorithm::EdgeShape() const {
+  if (graph_.HasCompressedRows()) return {1, graph_.GetEdgeCount()};
+  return {graph_.Size(), graph_.Size()};
+}
+
+/**
+ * @brief Returns the value of edge (i, j) in a per-edge matrix.
+ *
+ * @param matrix Pheromones, visibility or choice info.
+ * @param i The vertex the edge leaves.
+ * @param j The vertex the edge enters.
+ * @return Pointer to the value, or null if the compressed rows have no such
+ * edge.
+ */
+double *AntAlgorithm::Edge(Pheromones &matrix, int i, int j) const {
+  if (!graph_.HasCompressedRows()) return &matrix(i, j);
+  const long edge = graph_.GetEdgeIndex(i, j);
+  return edge < 0 ? nullptr : &matrix(0, edge);
+}
+
+/**
+ * @brief Copies the value of edge (i, j) to edge (j, i), if the latter
+ * exists. In compressed rows the opposite edge is found without a search.
+ *
+ * @param matrix Pheromones, visibility or choice info.
+ * @param edge The value of edge (i, j), as returned by Edge.
+ * @param i The vertex the edge leaves.
+ * @param j The vertex the edge enters.
+ */
+void AntAlgorithm::Mirror(Pheromones &matrix, const double *edge, int i,
+                          int j) const {
+  if (!graph_.HasCompressedRows()) {
+    matrix(j, i) = *edge;
+    return;
   }
+  const long back = graph_.GetReverseEdge(edge - matrix.Data());
+  if (back >= 0) matrix(0, back) = *edge;
+}
+
+/**
+ * @brief Runs block over the per-edge matrices piece by piece: row by row
+ * for matrix graphs, or in column blocks of the single row of compressed
+ * rows.
+ * When ants run in parallel, the pieces are shared among the pool threads.
+ *
+ * @param block Called with a row and a column range of that row.
+ */
+void AntAlgorithm::ForEachEdgeBlock(const EdgeBlock &block) {
+  const auto shape = EdgeShape();
+  const bool single_row = shape.first == 1;
+  const ThreadPool::Body body = [&block, &shape, single_row](size_t begin,
+                                                             size_t end) {
+    if (single_row) return block(0, begin, end);
+    for (size_t row = begin; row < end; ++row) {
+      block(row, 0, shape.second);
+    }
+  };
+  const size_t count = single_row ? shape.second : shape.first;
+  if (parallelism_ != Parallelism::kAnts) return body(0, count);
+  GetPool().ParallelFor(count, body, single_row ? kEdgeGrain : 0);
+}
+
+/**
+ * @brief Splits the vertices into one range per pool thread and runs body on
+ * every range. An undirected edge belongs to the range of its lower vertex,
+ * so ranges are sized for an equal number of vertex pairs. When every range
+ * updates only the edges it owns, including their mirrors, no two threads
+ * write the same pheromone, and each edge sees its updates in the same order
+ * as with a single thread, so no atomics or merge step are needed.
+ *
+ * @param body Called with the first vertex of a range and the one past it.
+ */
+void AntAlgorithm::ForEachOwnedRange(const ThreadPool::Body &body) {
+  const size_t vertex_cnt = graph_.Size();
+  if (parallelism_ != Parallelism::kAnts) return body(0, vertex_cnt);
+  ThreadPool &pool = GetPool();
+  const size_t parts = pool.Size();
+  const auto bound = [vertex_cnt, parts](size_t part) {
+    const double left = 1.0 - static_cast<double>(part) / parts;
+    return vertex_cnt - static_cast<size_t>(vertex_cnt * std::sqrt(left));
+  };
+  pool.ParallelFor(
+      parts,
+      [&body, &bound](size_t begin, size_t end) {
+        for (size_t part = begin; part < end; ++part) {
+          body(bound(part), bound(part + 1));
+        }
+      },
+      1);
+}
+
+/**
+ * @brief Returns the number of ants per colony: the configured one, at most
+ * one per vertex, or by default one per vertex, capped at kCoordinateAnts on
+ * coordinate graphs so that their paths take O(n) memory.
+ *
+ * @return size_t
+ */
+size_t AntAlgorithm::AntCount() const {
+  const size_t vertex_cnt = graph_.Size();
+  if (consts_.ants) return std::min(consts_.ants, vertex_cnt);
+  if (graph_.HasCoordinates()) return std::min(vertex_cnt, kCoordinateAnts);
+  return vertex_cnt;
+}
+
+/**
+ * @brief Allocates the ants of a colony once, in an arena: the paths of all
+ * ants are rows of one matrix and so are their tabu bitmasks. Every row starts
+ * on its own cache line, so parallel ants never write to a shared line.
+ *
+ * @param colony The colony whose ants are created.
+ */
+void AntAlgorithm::CreateAnts(Colony &colony) {
+  const size_t vertex_cnt = graph_.Size();
+  const size_t ant_cnt = AntCount();
+  const double exploitation =
+      consts_.update == PheromoneUpdate::kAntColonySystem ? consts_.q0 : 0.0;
+  colony.paths = Matrix<int>(ant_cnt, vertex_cnt + 1);
+  colony.tabu = Matrix<uint64_t>(ant_cnt, (vertex_cnt + 63) / 64);
+  colony.ants.clear();
+  colony.ants.reserve(ant_cnt);
+  for (size_t i = 0; i < ant_cnt; ++i) {
+    colony.ants.emplace_back(graph_, colony.paths.Row(i), colony.tabu.Row(i),
+                             consts_.candidates, exploitation);
+  }
+}
+
+/**
+ * @brief Simulates pass of the graph by each ant of a colony. With Ant Colony
+ * System, ants run one after another and the local update of every ant is
+ * applied before the next one starts. An ant never reconsiders an edge it
+ * has passed, since both its ends are visited, so this is the same as
+ * updating after every step.
+ *
+ * @param colony The colony whose ants make the bypass.
+ */
+void AntAlgorithm::RunAnts(Colony &colony) {
+  if (consts_.update != PheromoneUpdate::kAntColonySystem) {
+    ParallelBypass(colony, 0, colony.ants.size());
+    return;
+  }
+  for (size_t index = 0; index < colony.ants.size(); ++index) {
+    ParallelBypass(colony, index, index + 1);
+    LocalUpdate(colony, colony.ants[index]);
+  }
+}
+
+/**
+ * @brief Simulates parallel pass of the graph by each ant of a colony.
+ *
+ * @param colony The colony whose ants make the bypass.
+ */
+void AntAlgorithm::RunAntsParallel(Colony &colony) {
+  GetPool().ParallelFor(colony.ants.size(),
+                        [this, &colony](size_t begin, size_t end) {
+                          ParallelBypass(colony, begin, end);
+                        });
+}
+
+/**
+ * @brief Executes the Ant's MakeBypass method for a chunk of ants. With one
+ * ant per vertex every vertex is a start; fewer ants start at evenly spaced
+ * vertices. Every ant is reset in its own slot of the arena, so neither
+ * locking nor allocation is needed.
+ *
+ * @param colony The colony whose ants make the bypass.
+ * @param begin The index of the first ant of the chunk.
+ * @param end The index past the last ant of the chunk.
+ */
+void AntAlgorithm::ParallelBypass(Colony &colony, const size_t begin,
+                                  const size_t end) {
+  const size_t vertex_cnt = graph_.Size();
+  const size_t ant_cnt = colony.ants.size();
+  for (size_t index = begin; index < end; ++index) {
+    Ant &ant = colony.ants[index];
+    ant.Reset(index * vertex_cnt / ant_cnt,
+              Random::Derive(colony.bypass_seed, index));
+    ant.MakeBypass(colony.choice_info);
+  }
+}
+
+/**
+ * @brief Applies local search to the tours of all ants, or only to the best
+ * tour of the bypass, before they deposit pheromones. When ants run in
+ * parallel, each worker improves its own chunk of ants.
+ *
+ * @param colony The colony whose tours are improved.
+ */
+void AntAlgorithm::ImproveTours(Colony &colony) {
+  auto &ants = colony.ants;
+  const LocalSearchMethod method = consts_.local_search;
+  if (method == LocalSearchMethod::kNone or ants.empty()) return;
+
+  if (consts_.local_search_scope == LocalSearchScope::kIterationBest) {
+    LocalSearch search(graph_);
+    GetIterationBest(colony).ImprovePath(search, method);
+    return;
+  }
+
+  const auto improve = [this, &ants, method](size_t begin, size_t end) {
+    LocalSearch search(graph_);
+    for (size_t i = begin; i < end; ++i) {
+      ants[i].ImprovePath(search, method);
+    }
+  };
+  if (parallelism_ == Parallelism::kAnts) {
+    GetPool().ParallelFor(ants.size(), improve);
+  } else {
+    improve(0, ants.size());
+  }
+}
+
+/**
+ * @brief Updates pheromone levels after a bypass with the configured rule.
+ * The classic rule makes every ant reinforce the edges it has passed from a
+ * lower to a higher vertex index, so the work is proportional to the total
+ * length of the tours instead of the number of vertex pairs. When ants run in
+ * parallel, so do evaporation and deposits, each thread updating only the
+ * pheromones it owns.
+ *
+ * @param colony The colony whose pheromones are updated.
+ */
+void AntAlgorithm::UpdatePheromones(Colony &colony) {
+  if (consts_.update == PheromoneUpdate::kMaxMin) {
+    UpdateMaxMin(colony);
+  } else if (consts_.update == PheromoneUpdate::kAntColonySystem) {
+    UpdateAntColonySystem(colony);
+  } else {
+    ForEachOwnedRange([this, &colony](size_t first, size_t last) {
+      for (const auto &ant : colony.ants) {
+        Deposit(colony.pheromones, ant.GetPath(), ant.GetPathSize(),
+                ant.GetDistance(), first, last);
+      }
+    });
+  }
+}
+
+/**
+ * @brief MAX-MIN Ant System update: evaporation, a deposit by the best ant of
+ * the bypass (by the best tour of the colony every kGlobalBestInterval
+ * bypasses) and clamping to [tau_max / 2n, tau_max], tau_max = q / (ro * L),
+ * where L is the length of the best tour of the colony.
+ *
+ * @param colony The colony whose pheromones are updated.
+ */
+void AntAlgorithm::UpdateMaxMin(Colony &colony) {
+  auto &pheromones = colony.pheromones;
+  const size_t vertex_cnt = graph_.Size();
+  ForEachEdgeBlock([this, &pheromones](size_t row, size_t begin, size_t end) {
+    double *values = pheromones.Row(row);
+    for (size_t j = begin; j < end; ++j) {
+      values[j] *= 1.0 - consts_.ro;
+    }
+  });
+
+  const Ant &best = GetIterationBest(colony);
+  if (++colony.bypass % kGlobalBestInterval == 0 and
+      !colony.result.vertices.empty()) {
+    Deposit(pheromones, colony.result.vertices.data(),
+            colony.result.vertices.size(), colony.result.distance);
+  } else {
+    Deposit(pheromones, best.GetPath(), best.GetPathSize(),
+            best.GetDistance());
+  }
+
+  if (colony.result.distance <= 0.0 or
+      std::isinf(colony.result.distance)) {
+    return;
+  }
+  const double tau_max = consts_.q / (consts_.ro * colony.result.distance);
+  const double tau_min = tau_max / (2.0 * vertex_cnt);
+  ForEachEdgeBlock([&pheromones, tau_min, tau_max](size_t row, size_t begin,
+                                                   size_t end) {
+    double *values = pheromones.Row(row);
+    for (size_t j = begin; j < end; ++j) {
+      values[j] = std::clamp(values[j], tau_min, tau_max);
+    }
+  });
+}
+
+/**
+ * @brief Ant Colony System local update of the edges passed by one ant: each
+ * moves towards the initial level, and its choice info is recomputed so that
+ * the next ants of the bypass see it.
+ *
+ * @param colony The colony of the ant.
+ * @param ant The ant that has made its bypass.
+ */
+void AntAlgorithm::LocalUpdate(Colony &colony, const Ant &ant) {
+  auto &pheromones = colony.pheromones;
+  const int *path = ant.GetPath();
+  for (size_t k = 1; k < ant.GetPathSize(); ++k) {
+    double *pheromone = Edge(pheromones, path[k - 1], path[k]);
+    if (!pheromone) continue;
+    *pheromone = (1.0 - consts_.xi) * *pheromone + consts_.xi * initial_tau_;
+    Mirror(pheromones, pheromone, path[k - 1], path[k]);
+    UpdateEdgeChoiceInfo(colony, pheromone);
+    const double *back = Edge(pheromones, path[k], path[k - 1]);
+    if (back) UpdateEdgeChoiceInfo(colony, back);
+  }
+}
+
+/**
+ * @brief Recomputes the choice info of one edge.
+ *
+ * @param colony The colony.
+ * @param pheromone The pheromone of the edge, as returned by Edge.
+ */
+void AntAlgorithm::UpdateEdgeChoiceInfo(Colony &colony,
+                                        const double *pheromone) {
+  const size_t edge = pheromone - colony.pheromones.Data();
+  choice_kernel_(pheromone, visibility_.Data() + edge,
+                 colony.choice_info.Data() + edge, 1, consts_.alpha);
+}
+
+/**
+ * @brief Ant Colony System update: the best tour of the colony is
+ * reinforced. The local update has already been applied by RunAnts, except
+ * when ants run in parallel: they only read pheromones during construction,
+ * so the local update of all their edges is applied here. That variant only
+ * evaporates used edges further and does not steer the ants of the same
+ * bypass apart. Only O(ants * n) edges are touched.
+ *
+ * @param colony The colony whose pheromones are updated.
+ */
+void AntAlgorithm::UpdateAntColonySystem(Colony &colony) {
+  auto &pheromones = colony.pheromones;
+  if (parallelism_ == Parallelism::kAnts) DeferredLocalUpdate(colony);
+  if (!colony.result.vertices.empty()) {
+    Deposit(pheromones, colony.result.vertices.data(),
+            colony.result.vertices.size(), colony.result.distance);
+  }
+}
+
+/**
+ * @brief Applies the local update of all ants of a bypass at once, each
+ * pool thread updating the edges it owns.
+ *
+ * @param colony The colony whose ants have made the bypass.
+ */
+void AntAlgorithm::DeferredLocalUpdate(Colony &colony) {
+  auto &pheromones = colony.pheromones;
+  ForEachOwnedRange([this, &colony, &pheromones](size_t first, size_t last) {
+    for (const auto &ant : colony.ants) {
+      const int *path = ant.GetPath();
+      for (size_t k = 1; k < ant.GetPathSize(); ++k) {
+        const size_t owner = std::min(path[k - 1], path[k]);
+        if (owner < first or owner >= last) continue;
+        double *pheromone = Edge(pheromones, path[k - 1], path[k]);
+        if (!pheromone) continue;
+        *pheromone =
+            (1.0 - consts_.xi) * *pheromone + consts_.xi * initial_tau_;
+        Mirror(pheromones, pheromone, path[k - 1], path[k]);
+      }
+    }
+  });
+}
+
+/**
+ * @brief Reinforces the edges of one tour with the configured rule. The
+ * classic rule skips the closing edge and edges passed from a higher to a
+ * lower vertex index. A path left open, with no edge back to its start, has
+ * no closing edge, so its last edge is reinforced too.
+ *
+ * @param pheromones The pheromones to update.
+ * @param path The tour.
+ * @param size The number of vertices in the tour.
+ * @param distance The length of the tour.
+ */
+void AntAlgorithm::Deposit(Pheromones &pheromones, const int *path,
+                           size_t size, double distance) {
+  Deposit(pheromones, path, size, distance, 0, graph_.Size());
+}
+
+/**
+ * @brief Reinforces the edges of one tour whose lower vertex lies in
+ * [first, last), leaving the other edges to the owners of their ranges.
+ *
+ * @param pheromones The pheromones to update.
+ * @param path The tour.
+ * @param size The number of vertices in the tour.
+ * @param distance The length of the tour.
+ * @param first The first vertex of the range.
+ * @param last The vertex past the last one of the range.
+ */
+void AntAlgorithm::Deposit(Pheromones &pheromones, const int *path,
+                           size_t size, double distance, size_t first,
+                           size_t last) {
+  const double deposit = consts_.q / distance;
+  if (consts_.update == PheromoneUpdate::kClassic) {
+    const size_t end = size and path[size - 1] == path[0] ? size : size + 1;
+    for (size_t k = 2; k < end; ++k) {
+      const int i = path[k - 2];
+      const int j = path[k - 1];
+      if (i >= j or static_cast<size_t>(i) < first or
+          static_cast<size_t>(i) >= last) {
+        continue;
+      }
+      double *pheromone = Edge(pheromones, i, j);
+      if (!pheromone) continue;
+      *pheromone += (1.0 - consts_.ro) * *pheromone + deposit;
+      Mirror(pheromones, pheromone, i, j);
+    }
+    return;
+  }
+  for (size_t k = 1; k < size; ++k) {
+    const size_t owner = std::min(path[k - 1], path[k]);
+    if (owner < first or owner >= last) continue;
+    double *pheromone = Edge(pheromones, path[k - 1], path[k]);
+    if (!pheromone) continue;
+    *pheromone = consts_.update == PheromoneUpdate::kMaxMin
+                     ? *pheromone + deposit
+                     : (1.0 - consts_.ro) * *pheromone + consts_.ro * deposit;
+    Mirror(pheromones, pheromone, path[k - 1], path[k]);
+  }
+}
+
+/**
+ * @brief Returns the ant with the shortest complete tour of the bypass, or
+ * the shortest incomplete one if no ant has completed its tour. Tour lengths
+ * are cached in the ants, so this is a single pass over the colony; when ants
+ * run in parallel, every worker reduces its own chunk and the chunk winners
+ * are compared in order, so ties always go to the lowest start vertex.
+ *
+ * @param colony The colony.
+ * @return Ant&
+ */
+Ant &AntAlgorithm::GetIterationBest(Colony &colony) {
+  auto &ants = colony.ants;
+  const auto reduce = [&ants](size_t begin, size_t end) {
+    size_t best = begin;
+    for (size_t i = begin + 1; i < end; ++i) {
+      if (IsBetter(ants[i], ants[best])) best = i;
+    }
+    return best;
+  };
+  if (parallelism_ != Parallelism::kAnts) {
+    return ants[reduce(0, ants.size())];
+  }
+
+  ThreadPool &pool = GetPool();
+  const size_t grain = (ants.size() + pool.Size() - 1) / pool.Size();
+  std::vector<size_t> winners((ants.size() + grain - 1) / grain);
+  pool.ParallelFor(
+      ants.size(),
+      [&](size_t begin, size_t end) {
+        winners[begin / grain] = reduce(begin, end);
+      },
+      grain);
+  size_t best = winners.front();
+  for (const size_t winner : winners) {
+    if (IsBetter(ants[winner], ants[best])) best = winner;
+  }
+  return ants[best];
+}
+
+/**
+ * @brief Orders ants by completeness of their tours, then by tour length.
+ *
+ * @return True if the tour of x is better than the tour of y.
+ */
+bool AntAlgorithm::IsBetter(const Ant &x, const Ant &y) {
+  if (x.IsComplete() != y.IsComplete()) return x.IsComplete();
+  return x.GetDistance() < y.GetDistance();
+}
+
+/**
+ * @brief Updates the current best TSP path found by the colony. The path is
+ * copied only when the best ant of the bypass completes a shorter tour.
+ *
+ * @param colony The colony whose result is updated.
+ */
+void AntAlgorithm::UpdateResult(Colony &colony) {
+  if (colony.ants.empty()) return;
+  const Ant &best = GetIterationBest(colony);
+  if (best.IsComplete() and best.GetDistance() < colony.result.distance) {
+    colony.result.vertices.assign(best.GetPath(),
+                                  best.GetPath() + best.GetPathSize());
+    colony.result.distance = best.GetDistance();
+    if (consts_.target > 0.0 and colony.result.distance <= consts_.target) {
+      stop_ = true;
+    }
+    if (bound_) bound_->SetUpperBound(colony.result.distance);
+  }
+}
+
+/**
+ * @brief Checks whether the run has been stopped by reaching the target
+ * length or, from now on, by running out of time or by closing the gap to the
+ * lower bound.
+ *
+ * @return True if no more bypasses should be made.
+ */
+bool AntAlgorithm::IsStopped() {
+  if (stop_) return true;
+  if (consts_.time_limit > 0.0 and
+      std::chrono::steady_clock::now() >= deadline_) {
+    stop_ = true;
+  }
+  if (consts_.gap > 0.0 and bound_ and bound_->Gap() <= consts_.gap) {
+    stop_ = true;
+  }
+  return stop_;
+}
+
+/**
+ * @brief Checks whether a colony is unlikely to find shorter tours: it has
+ * made the configured number of bypasses without improvement, or the
+ * average lambda-branching factor of its pheromones has fallen to the
+ * configured value.
+ *
+ * @param colony The colony.
+ * @param stagnation Bypasses made since the last improvement.
+ * @return True if the colony should stop.
+ */
+bool AntAlgorithm::HasConverged(const Colony &colony,
+                                size_t stagnation) const {
+  if (consts_.stagnation and stagnation >= consts_.stagnation) return true;
+  return consts_.branching > 0.0 and
+         BranchingFactor(colony) <= consts_.branching;
+}
+
+/**
+ * @brief Computes the average lambda-branching factor of the pheromones of
+ * a colony: for every vertex, the number of its edges whose pheromone is at
+ * least tau_min + lambda * (tau_max - tau_min), where tau_min and tau_max are
+ * taken over the edges of that vertex. It starts at the average degree and
+ * approaches 2 as the colony converges to a single tour.
+ *
+ * @param colony The colony.
+ * @return double
+ */
+double AntAlgorithm::BranchingFactor(const Colony &colony) const {
+  const size_t vertex_cnt = graph_.Size();
+  const bool sparse = graph_.HasCompressedRows();
+  size_t strong = 0;
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    const size_t row = sparse ? 0 : i;
+    const size_t offset = sparse ? graph_.GetNeighborOffset(i) : 0;
+    const size_t count = sparse ? graph_.GetNeighborCount(i) : vertex_cnt;
+    const double *tau = colony.pheromones.Row(row) + offset;
+    const double *eta = visibility_.Row(row) + offset;
+    double low = std::numeric_limits<double>::infinity();
+    double high = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+      if (eta[k] > 0.0) {
+        low = std::min(low, tau[k]);
+        high = std::max(high, tau[k]);
+      }
+    }
+    const double threshold = low + kBranchingLambda * (high - low);
+    for (size_t k = 0; k < count; ++k) {
+      strong += eta[k] > 0.0 and tau[k] >= threshold;
+    }
+  }
+  return static_cast<double>(strong) / vertex_cnt;
+}
+
+/**
+ * @brief Returns the worker pool, creating it on first use.
+ *
+ * @return ThreadPool&
+ */
+ThreadPool &AntAlgorithm::GetPool() {
+  if (!pool_) pool_ = std::make_shared<ThreadPool>();
+  return *pool_;
 }
 
 /**
@@ -255,7 +1449,9 @@ void AntAlgorithm::UpdateResult() {
  * the ant colony algorithm.
  */
 TsmResult AntAlgorithm::GetResult() const {
-  if (!CheckResult()) {
+  bool valid = false;
+  ANT_TIMED(stats_.check_time, valid = CheckResult());
+  if (!valid) {
     throw std::logic_error(
         "It is impossible to solve the problem with a given graph");
   }
@@ -273,20 +1469,130 @@ TsmResult AntAlgorithm::GetResult() const {
  * otherwise.
  */
 bool AntAlgorithm::CheckResult() const {
-  const auto &graph = graph_.GetGraph();
-  Path vertices(graph.size());
-  std::iota(vertices.begin(), vertices.end(), 0);
-
-  return std::all_of(vertices.cbegin(), vertices.cend(), [&](const auto &v) {
-    return std::find(result_.vertices.cbegin(), result_.vertices.cend(), v) !=
-           result_.vertices.cend();
-  });
+  const size_t vertex_cnt = graph_.Size();
+  std::vector<bool> seen(vertex_cnt);
+  size_t count = 0;
+  for (int v : result_.vertices) {
+    if (v >= 0 and static_cast<size_t>(v) < vertex_cnt and !seen[v]) {
+      seen[v] = true;
+      ++count;
+    }
+  }
+  return count == vertex_cnt;
 }
 
 /**
  * @brief Sets the parallel flag for the AntAlgorithm.
  *
- * @param parallel A boolean value indicating whether the algorithm should run
- * in parallel.
+ * @param parallel A boolean value indicating whether the ants of a colony
+ * should run in parallel.
+ */
+void AntAlgorithm::SetParallel(bool parallel) {
+  parallelism_ = parallel ? Parallelism::kAnts : Parallelism::kNone;
+}
+
+/**
+ * @brief Chooses what runs in parallel: the ants within each bypass, or whole
+ * independent colonies. The latter fills the cores when graphs are too small
+ * to split one bypass between threads.
+ *
+ * @param parallelism The parallelism mode.
+ */
+void AntAlgorithm::SetParallelism(Parallelism parallelism) {
+  parallelism_ = parallelism;
+}
+
+/**
+ * @brief Seeds the master generator. Every colony gets its own seed from it,
+ * and every ant a seed derived from the colony's bypass seed and its index,
+ * so the same seed reproduces the same results regardless of
+ * parallelism and thread count.
+ *
+ * @param seed The master seed.
+ */
+void AntAlgorithm::SetSeed(uint64_t seed) { random_ = Random(seed); }
+
+/**
+ * @brief Enables the candidate list mode, in which ants choose only among the
+ * nearest neighbors of the current vertex. The length is limited by the
+ * candidate lists of the graph, which Graph::ExtendCandidateLists makes
+ * longer than Graph::kCandidateCount.
+ *
+ * @param count The number of nearest neighbors to consider, or 0 to consider
+ * all vertices.
+ */
+void AntAlgorithm::SetCandidateList(size_t count) {
+  consts_.candidates = count;
+}
+
+/**
+ * @brief Enables improvement of ant tours with local search before the
+ * pheromone update, like the local_search and local_search_scope parameters.
+ * Works only on graphs with symmetric weights.
+ *
+ * @param method Neighborhoods to search, kNone to disable local search.
+ * @param scope Whether every ant's tour or only the best tour of each bypass
+ * is improved.
+ */
+void AntAlgorithm::SetLocalSearch(LocalSearchMethod method,
+                                  LocalSearchScope scope) {
+  consts_.local_search = method;
+  consts_.local_search_scope = scope;
+}
+
+/**
+ * @brief Configures the island model used by Parallelism::kIslands.
+ *
+ * @param count The number of islands, 0 to use one island per pool thread.
+ * @param interval The number of bypasses between migrations.
+ */
+void AntAlgorithm::SetIslands(size_t count, size_t interval) {
+  consts_.islands = count;
+  consts_.migration_interval = std::max<size_t>(interval, 1);
+}
+
+/**
+ * @brief Chooses the pheromone update rule.
+ *
+ * @param update The rule.
+ */
+void AntAlgorithm::SetPheromoneUpdate(PheromoneUpdate update) {
+  consts_.update = update;
+}
+
+/**
+ * @brief Replaces all hyperparameters of the algorithm.
+ *
+ * @param heuristics New hyperparameters.
+ * @throw std::logic_error if a parameter is invalid.
+ */
+void AntAlgorithm::SetHeuristics(const Heuristics &heuristics) {
+  heuristics.Validate();
+  consts_ = heuristics;
+}
+
+/**
+ * @brief Returns hyperparameters of the algorithm.
+ *
+ * @return const Heuristics&
+ */
+const Heuristics &AntAlgorithm::GetHeuristics() const { return consts_; }
+
+/**
+ * @brief Returns the timings and counters of the last run. They are zero
+ * unless the model is built with ANT_STATS; the check time is updated by
+ * GetResult. Thread busy and idle times count every loop run on the pool
+ * during the run, so they are only meaningful if the pool is not shared
+ * with concurrent runs.
+ *
+ * @return const AlgorithmStats&
+ */
+const AlgorithmStats &AntAlgorithm::GetStats() const { return stats_; }
+
+/**
+ * @brief Returns the number of bypasses made by all colonies in the last
+ * run, which is less than colonies * bypass_count if they stopped early.
+ *
+ * @return size_t
  */
-void AntAlgorithm::SetParallel(bool parallel) { parallel_ = parallel; }
+size_t AntAlgorithm::GetBypassCount() const { return bypasses_; }
@@ -2,81 +2,201 @@
 #define PARALLELS_ANT_MODEL_ANT_ALGORITHM_H_
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <random>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include "exact_solver.h"
 #include "graph.h"
 #include "heuristics.h"
+#include "kernels.h"
+#include "local_search.h"
+#include "lower_bound.h"
+#include "random.h"
+#include "stats.h"
+#include "thread_pool.h"
 
+/**
+ * @brief A tour and its length. If the Held-Karp bound has been computed,
+ * the result also holds the bound and the relative gap (distance - bound) /
+ * bound, which is infinite otherwise.
+ *
+ */
 struct TsmResult {
   std::vector<int> vertices;
   double distance = 0.0;
+  double lower_bound = 0.0;
+  double gap = std::numeric_limits<double>::infinity();
 };
 
 class Ant {
  public:
   using Path = std::vector<int>;
-  using Tabu = std::vector<bool>;
-  using Visited = std::vector<std::pair<size_t, size_t>>;
-  using Pheromones = std::vector<std::vector<double>>;
+  using ChoiceInfo = Matrix<double>;
   using Chances = std::vector<double>;
 
-  Ant(const Graph &, size_t);
+  Ant(const Graph &, int *, uint64_t *, size_t = 0, double = 0.0);
 
-  void MakeBypass(const Pheromones &);
+  void Reset(size_t, uint64_t);
+  void MakeBypass(const ChoiceInfo &);
+  bool ImprovePath(LocalSearch &, LocalSearchMethod);
   double GetDistance() const;
-  Path GetPath() const;
-  bool IsVisited(size_t, size_t) const;
+  bool IsComplete() const;
+  const int *GetPath() const;
+  size_t GetPathSize() const;
+  size_t GetSteps() const;
+  bool HasDeadEnd() const;
 
  private:
-  int ChooseNextPath(const Pheromones &, size_t);
-  Chances GetChances(const Pheromones &, size_t);
+  int ChooseNextPath(const ChoiceInfo &, size_t);
+  int ChooseNeighbor(const ChoiceInfo &, size_t);
+  int ChooseCandidate(const ChoiceInfo &, size_t);
+  int ChooseBest(const ChoiceInfo &, size_t);
+  int ChooseNearest(size_t) const;
+  const double *ChoiceRow(const ChoiceInfo &, size_t) const;
+  const int *CandidateColumns(size_t) const;
+  bool IsVisited(size_t) const;
+  void Visit(size_t);
   double RandomChoice(const double, const double);
+  void ComputeDistance();
 
  private:
   const Graph &graph_;
-  Tabu tabu_;
-  Path path_;
-  Visited visited_;
-  Heuristics consts_;
+  int *path_;
+  size_t path_size_;
+  uint64_t *tabu_;
+  Chances chances_;
+  Random random_;
+  size_t candidates_;
+  double exploitation_;
+  double distance_;
+  size_t steps_;
+  bool dead_end_;
 };
 
+enum class Parallelism { kNone, kAnts, kColonies, kIslands };
+
 class AntAlgorithm {
  public:
   using Path = std::vector<int>;
-  using Ants = std::vector<std::unique_ptr<Ant>>;
-  using Threads = std::vector<std::thread>;
-  using Pheromones = std::vector<std::vector<double>>;
-  using Chances = std::vector<double>;
+  using Ants = std::vector<Ant>;
+  using Pheromones = Matrix<double>;
+  using ChoiceInfo = Matrix<double>;
 
  public:
-  explicit AntAlgorithm(const Graph &);
+  explicit AntAlgorithm(const Graph &,
+                        std::shared_ptr<ThreadPool> pool = nullptr);
 
   void RunAlgorithm();
   TsmResult GetResult() const;
   void SetParallel(const bool);
+  void SetParallelism(Parallelism);
+  void SetSeed(uint64_t);
+  void SetCandidateList(size_t);
+  void SetLocalSearch(LocalSearchMethod,
+                      LocalSearchScope = LocalSearchScope::kEachAnt);
+  void SetIslands(size_t, size_t);
+  void SetPheromoneUpdate(PheromoneUpdate);
+  void SetHeuristics(const Heuristics &);
+  const Heuristics &GetHeuristics() const;
+  const AlgorithmStats &GetStats() const;
+  size_t GetBypassCount() const;
 
  private:
-  void RunColony();
-  void RunAnts();
-  void RunAntsParallel();
-  void UpdatePheromones();
-  void UpdateResult();
+  static constexpr size_t kGlobalBestInterval = 5;
+  static constexpr size_t kEdgeGrain = 4096;
+  static constexpr double kBranchingLambda = 0.05;
+  static constexpr double kMinDistance = 0.5;
+  static constexpr size_t kCoordinateAnts = 100;
+
+  struct Colony {
+    Pheromones pheromones;
+    ChoiceInfo choice_info;
+    Matrix<int> paths;
+    Matrix<uint64_t> tabu;
+    Ants ants;
+    TsmResult result;
+    Random random;
+    uint64_t bypass_seed = 0;
+    size_t bypass = 0;
+    AlgorithmStats stats;
+  };
+
+  using Mailbox = std::shared_ptr<const TsmResult>;
+  using EdgeBlock = std::function<void(size_t, size_t, size_t)>;
+
+  struct Island {
+    std::vector<Mailbox> *mailboxes;
+    size_t index;
+  };
+
+  void Solve();
+  void SolveExactly();
+  void RunSearch(const std::vector<uint64_t> &);
+  void RunColonies(const std::vector<uint64_t> &);
+  void RunColoniesParallel(const std::vector<uint64_t> &);
+  void RunIslands(const std::vector<uint64_t> &);
+  void RunColony(Colony &, uint64_t, Island * = nullptr);
+  void Migrate(Colony &, Island &);
+  void CountBypass(Colony &);
+  void MergeStats(Colony &);
+  void CollectThreadStats(const std::vector<double> &);
+  size_t AntCount() const;
+  void CreateAnts(Colony &);
+  void RunAnts(Colony &);
+  void RunAntsParallel(Colony &);
+  void UpdatePheromones(Colony &);
+  void UpdateMaxMin(Colony &);
+  void UpdateAntColonySystem(Colony &);
+  void LocalUpdate(Colony &, const Ant &);
+  void UpdateEdgeChoiceInfo(Colony &, const double *);
+  void DeferredLocalUpdate(Colony &);
+  void Deposit(Pheromones &, const int *, size_t, double);
+  void Deposit(Pheromones &, const int *, size_t, double, size_t, size_t);
+  void InitTau();
+  void UpdateChoiceInfo(Colony &);
+  std::pair<size_t, size_t> EdgeShape() const;
+  double *Edge(Pheromones &, int, int) const;
+  void Mirror(Pheromones &, const double *, int, int) const;
+  void ForEachEdgeBlock(const EdgeBlock &);
+  void ForEachOwnedRange(const ThreadPool::Body &);
+  void InitVisibility();
+  void ImproveTours(Colony &);
+  Ant &GetIterationBest(Colony &);
+  static bool IsBetter(const Ant &, const Ant &);
+  void UpdateResult(Colony &);
+  bool IsStopped();
+  bool HasConverged(const Colony &, size_t) const;
+  double BranchingFactor(const Colony &) const;
   bool CheckResult() const;
-  void ParallelBypass(size_t);
+  void ParallelBypass(Colony &, size_t, size_t);
+  ThreadPool &GetPool();
 
  private:
   const Graph &graph_;
   TsmResult result_;
-  Ants ants_;
-  Pheromones pheromones_;
+  Colony colony_;
+  ChoiceInfo visibility_;
+  double initial_tau_;
   Heuristics consts_;
-  std::mutex mtx_;
-  bool parallel_;
+  std::shared_ptr<ThreadPool> pool_;
+  Random random_;
+  ChoiceKernel choice_kernel_;
+  Parallelism parallelism_;
+  std::atomic<bool> stop_;
+  std::atomic<size_t> bypasses_;
+  std::chrono::steady_clock::time_point deadline_;
+  std::unique_ptr<LowerBound> bound_;
+  mutable AlgorithmStats stats_;
+  std::mutex stats_mtx_;
 };
 
 #endif  // PARALLELS_ANT_MODEL_ANT_ALGORITHM_H_
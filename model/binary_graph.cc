@@ -0,0 +1,32 @@
+#include "binary_graph.h"
+
+#include <algorithm>
+#include <iterator>
+
+/**
+ * @brief Checks if the data starts with the magic of the binary graph format
+ *
+ * @param data
+ * @param size
+ * @return bool
+ */
+bool IsBinaryGraph(const char *data, size_t size) {
+  return size >= sizeof(BinaryGraphHeader) and
+         std::equal(std::begin(kBinaryGraphMagic), std::end(kBinaryGraphMagic),
+                    data);
+}
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of the data
+ *
+ * @param data
+ * @param size
+ * @return uint64_t
+ */
+uint64_t BinaryGraphChecksum(const char *data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+  }
+  return hash;
+}
@@ -0,0 +1,44 @@
+#ifndef PARALLELS_ANT_MODEL_BINARY_GRAPH_H_
+#define PARALLELS_ANT_MODEL_BINARY_GRAPH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Header of the binary graph format. The file is laid out so that it
+ * can be memory-mapped and used in place:
+ *
+ *   header (64 bytes)
+ *   weights: size rows of stride int32 values
+ *   candidate lists: size rows of candidate_stride int32 values
+ *   candidate list lengths: size uint32 values
+ *
+ * Row strides are padded to 64 bytes, as in Matrix, so every row starts on a
+ * cache line of the page-aligned mapping. Values are stored in the byte order
+ * of the machine that wrote the file; the magic catches a mismatch. The
+ * checksum is FNV-1a over everything after the header.
+ */
+struct BinaryGraphHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t weight_type;
+  uint64_t size;
+  uint64_t stride;
+  uint64_t candidate_count;
+  uint64_t candidate_stride;
+  uint32_t flags;
+  uint32_t reserved;
+  uint64_t checksum;
+};
+
+static_assert(sizeof(BinaryGraphHeader) == 64, "Binary graph header size");
+
+constexpr char kBinaryGraphMagic[8] = {'A', 'N', 'T', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t kBinaryGraphVersion = 1;
+constexpr uint32_t kBinaryGraphInt32 = 1;
+constexpr uint32_t kBinaryGraphSymmetric = 1;
+
+bool IsBinaryGraph(const char *data, size_t size);
+uint64_t BinaryGraphChecksum(const char *data, size_t size);
+
+#endif  // PARALLELS_ANT_MODEL_BINARY_GRAPH_H_
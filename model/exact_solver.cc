@@ -0,0 +1,161 @@
+#include "exact_solver.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructs an ExactSolver object for the given graph.
+ *
+ * @param graph A reference to the graph to solve.
+ */
+ExactSolver::ExactSolver(const Graph &graph)
+    : graph_{graph}, bits_{0}, distance_{kInf} {}
+
+/**
+ * @brief Finds an optimal tour starting and ending at vertex 0. Bit b of a
+ * subset stands for vertex b + 1, and the table entry of a subset and bit b
+ * is the length of the shortest path that leaves vertex 0, visits the
+ * vertices of the subset and ends at vertex b + 1.
+ *
+ * @param pool If not null, large layers of subsets are split among its
+ * threads.
+ * @return False if the graph has no tour or more than kMaxSize or fewer than
+ * two vertices.
+ */
+bool ExactSolver::Solve(ThreadPool *pool) {
+  const size_t vertex_cnt = graph_.Size();
+  path_.clear();
+  distance_ = kInf;
+  if (vertex_cnt < 2 or vertex_cnt > kMaxSize) return false;
+
+  weights_.resize(vertex_cnt * vertex_cnt);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    for (size_t j = 0; j < vertex_cnt; ++j) {
+      weights_[i * vertex_cnt + j] =
+          graph_.HasEdge(i, j) ? graph_.GetWeightUnchecked(i, j) : kInf;
+    }
+  }
+
+  bits_ = vertex_cnt - 1;
+  const uint32_t subset_cnt = uint32_t{1} << bits_;
+  table_.assign(subset_cnt * bits_, kInf);
+  for (size_t b = 0; b < bits_; ++b) {
+    table_[(size_t{1} << b) * bits_ + b] = Weight(0, b + 1);
+  }
+
+  std::vector<size_t> layers(bits_ + 2, 0);
+  for (uint32_t subset = 0; subset < subset_cnt; ++subset) {
+    ++layers[__builtin_popcount(subset) + 1];
+  }
+  for (size_t k = 1; k < layers.size(); ++k) {
+    layers[k] += layers[k - 1];
+  }
+  std::vector<uint32_t> subsets(subset_cnt);
+  std::vector<size_t> next(layers.begin(), layers.end() - 1);
+  for (uint32_t subset = 0; subset < subset_cnt; ++subset) {
+    subsets[next[__builtin_popcount(subset)]++] = subset;
+  }
+
+  for (size_t layer = 2; layer <= bits_; ++layer) {
+    const uint32_t *first = subsets.data() + layers[layer];
+    const size_t count = layers[layer + 1] - layers[layer];
+    const ThreadPool::Body body = [this, first](size_t begin, size_t end) {
+      SolveSubsets(first + begin, end - begin);
+    };
+    if (pool and count > kGrain) {
+      pool->ParallelFor(count, body, kGrain);
+    } else {
+      body(0, count);
+    }
+  }
+
+  const size_t full = subset_cnt - 1;
+  int last = -1;
+  for (size_t b = 0; b < bits_; ++b) {
+    const long long length = table_[full * bits_ + b];
+    const long long closing = Weight(b + 1, 0);
+    if (length < kInf and closing < kInf and length + closing < distance_) {
+      distance_ = length + closing;
+      last = b;
+    }
+  }
+  if (last == -1) return false;
+  Reconstruct(last);
+  return true;
+}
+
+/**
+ * @brief Returns the optimal tour found by Solve, vertex 0 repeated at the
+ * end, or an empty path if there is none.
+ *
+ * @return const std::vector<int>&
+ */
+const std::vector<int> &ExactSolver::GetPath() const { return path_; }
+
+/**
+ * @brief Returns the length of the optimal tour found by Solve.
+ *
+ * @return long long
+ */
+long long ExactSolver::GetDistance() const { return distance_; }
+
+/**
+ * @brief Fills the table entries of subsets of one layer from the entries of
+ * the previous layer.
+ *
+ * @param subsets The subsets to fill.
+ * @param count The number of subsets.
+ */
+void ExactSolver::SolveSubsets(const uint32_t *subsets, size_t count) {
+  for (size_t s = 0; s < count; ++s) {
+    const uint32_t subset = subsets[s];
+    long long *entries = table_.data() + subset * bits_;
+    for (uint32_t rest = subset; rest; rest &= rest - 1) {
+      const int b = __builtin_ctz(rest);
+      const long long *previous =
+          table_.data() + (subset ^ (uint32_t{1} << b)) * bits_;
+      long long best = kInf;
+      for (uint32_t from = subset ^ (uint32_t{1} << b); from;
+           from &= from - 1) {
+        const int k = __builtin_ctz(from);
+        const long long weight = Weight(k + 1, b + 1);
+        if (previous[k] < kInf and weight < kInf) {
+          best = std::min(best, previous[k] + weight);
+        }
+      }
+      entries[b] = best;
+    }
+  }
+}
+
+/**
+ * @brief Restores the optimal tour by walking the table back from the full
+ * subset.
+ *
+ * @param last The bit of the last vertex before returning to vertex 0.
+ */
+void ExactSolver::Reconstruct(int last) {
+  uint32_t subset = (uint32_t{1} << bits_) - 1;
+  int b = last;
+  path_.assign(1, 0);
+  while (true) {
+    path_.push_back(b + 1);
+    const uint32_t previous = subset ^ (uint32_t{1} << b);
+    if (!previous) break;
+    const long long length = table_[subset * bits_ + b];
+    for (uint32_t from = previous; from; from &= from - 1) {
+      const int k = __builtin_ctz(from);
+      const long long before = table_[previous * bits_ + k];
+      if (before < kInf and before + Weight(k + 1, b + 1) == length) {
+        b = k;
+        break;
+      }
+    }
+    subset = previous;
+  }
+  path_.push_back(0);
+  std::reverse(path_.begin(), path_.end());
+}
+
+long long ExactSolver::Weight(int from, int to) const {
+  return weights_[from * graph_.Size() + to];
+}
@@ -0,0 +1,49 @@
+#ifndef PARALLELS_ANT_MODEL_EXACT_SOLVER_H_
+#define PARALLELS_ANT_MODEL_EXACT_SOLVER_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "graph.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Finds an optimal tour of a small graph with the Held-Karp dynamic
+ * program over subsets of vertices, in O(2^n * n^2) time and O(2^n * n)
+ * memory. Works for asymmetric graphs and graphs with missing edges.
+ *
+ * The table keeps the entries of one subset next to each other, and subsets
+ * are processed layer by layer, by the number of vertices in them. Subsets of
+ * a layer only read the previous layer, so a layer can be split among the
+ * threads of a pool.
+ */
+class ExactSolver {
+ public:
+  static constexpr size_t kMaxSize = 18;
+
+ public:
+  explicit ExactSolver(const Graph &graph);
+
+  bool Solve(ThreadPool *pool = nullptr);
+  const std::vector<int> &GetPath() const;
+  long long GetDistance() const;
+
+ private:
+  static constexpr long long kInf = std::numeric_limits<long long>::max() / 4;
+  static constexpr size_t kGrain = 256;
+
+  void SolveSubsets(const uint32_t *subsets, size_t count);
+  void Reconstruct(int last);
+  long long Weight(int from, int to) const;
+
+ private:
+  const Graph &graph_;
+  size_t bits_;
+  std::vector<long long> weights_;
+  std::vector<long long> table_;
+  std::vector<int> path_;
+  long long distance_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_EXACT_SOLVER_H_
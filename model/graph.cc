@@ -1,42 +1,686 @@
 #include "graph.h"
 
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+#include <utility>
+#include <stdexcept>
+
+#include "binary_graph.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+namespace {
+
+constexpr size_t kParallelParseBytes = size_t{1} << 20;
+
+bool IsSpace(char ch) {
+  return ch == ' ' or ch == '\n' or ch == '\t' or ch == '\r' or ch == '\v' or
+         ch == '\f';
+}
+
+bool IsDigit(char ch) { return ch >= '0' and ch <= '9'; }
+
+bool IsAlpha(char ch) {
+  return (ch >= 'A' and ch <= 'Z') or (ch >= 'a' and ch <= 'z');
+}
+
+std::string_view Trim(std::string_view str) {
+  while (!str.empty() and IsSpace(str.front())) str.remove_prefix(1);
+  while (!str.empty() and IsSpace(str.back())) str.remove_suffix(1);
+  return str;
+}
+
+/**
+ * @brief Returns the next whitespace-separated token and moves begin past it,
+ * or an empty token at the end of the range.
+ */
+std::string_view NextToken(const char*& begin, const char* end) {
+  while (begin != end and IsSpace(*begin)) ++begin;
+  const char* token = begin;
+  while (begin != end and !IsSpace(*begin)) ++begin;
+  return std::string_view(token, begin - token);
+}
+
+template <typename T>
+bool ParseNumber(std::string_view token, T& value) {
+  const auto [ptr, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  return !token.empty() and ec == std::errc() and
+         ptr == token.data() + token.size();
+}
+
+/**
+ * @brief Result of parsing one chunk of edge weights.
+ */
+struct ParsedChunk {
+  size_t tokens = 0;
+  bool non_digit = false;
+  bool out_of_range = false;
+};
+
+/**
+ * @brief Counts whitespace-separated tokens in [begin, end).
+ */
+size_t CountTokens(const char* begin, const char* end) {
+  size_t count = 0;
+  bool in_token = false;
+  for (const char* ch = begin; ch != end; ++ch) {
+    const bool space = IsSpace(*ch);
+    count += !space and !in_token;
+    in_token = !space;
+  }
+  return count;
+}
+
+/**
+ * @brief Parses the weights in [begin, end), the first of them being weight
+ * number first in row-major order. Weights beyond the shape of the matrix are
+ * only counted, as the stream loader never looked at them.
+ */
+ParsedChunk ParseWeights(const char* begin, const char* end, size_t first,
+                         Graph::Matrix& matrix) {
+  const size_t cols = matrix.Cols();
+  const size_t total = matrix.Rows() * cols;
+  ParsedChunk chunk;
+  size_t row = first / cols;
+  size_t col = first % cols;
+  const char* ch = begin;
+  while (true) {
+    while (ch != end and IsSpace(*ch)) ++ch;
+    if (ch == end) break;
+    const char* token = ch;
+    while (ch != end and !IsSpace(*ch)) ++ch;
+    if (first + chunk.tokens++ >= total) continue;
+    int value = 0;
+    const auto [ptr, ec] = std::from_chars(token, ch, value);
+    if (IsDigit(*token) and ptr == ch and
+        ec == std::errc::result_out_of_range) {
+      chunk.out_of_range = true;
+      return chunk;
+    }
+    if (!IsDigit(*token) or ec != std::errc() or ptr != ch) {
+      chunk.non_digit = true;
+      return chunk;
+    }
+    matrix(row, col) = value;
+    if (++col == cols) {
+      col = 0;
+      ++row;
+    }
+  }
+  return chunk;
+}
+
+/**
+ * @brief Splits [begin, end) into about parts ranges that do not cut tokens.
+ */
+std::vector<const char*> SplitAtSpaces(const char* begin, const char* end,
+                                       size_t parts) {
+  std::vector<const char*> bounds{begin};
+  const size_t step = (end - begin) / parts;
+  for (size_t i = 1; i < parts; ++i) {
+    const char* bound = std::max(bounds.back(), begin + i * step);
+    while (bound != end and !IsSpace(*bound)) ++bound;
+    bounds.push_back(bound);
+  }
+  bounds.push_back(end);
+  return bounds;
+}
+
+}  // namespace
+
 /**
- * @brief Loading a graph from a file in the adjacency matrix format
+ * @brief Loading a graph from a file in the adjacency matrix format, in the
+ * binary format, which is recognized by its magic, or in the TSPLIB format
+ * with EUC_2D coordinates, which starts with a keyword. A text file is
+ * memory-mapped and parsed with std::from_chars; large matrices are split
+ * into chunks parsed concurrently on the given pool.
+ *
+ * The file is loaded into a new graph that replaces this one only once it
+ * is complete, so a graph that fails to load is left unchanged.
  *
  * @param filename
+ * @param pool Worker pool for parsing large files, or null to parse on the
+ * calling thread.
  */
-void Graph::LoadGraphFromFile(const std::string& filename) {
-  std::ifstream file(filename);
-  if (!file) throw std::logic_error("Open file error");
-  int vertex_cnt;
-  file >> vertex_cnt;
-  if (file.fail() or file.peek() != '\n' or vertex_cnt <= 0) {
+void Graph::LoadGraphFromFile(const std::string& filename, ThreadPool* pool) {
+  Graph graph;
+  graph.Load(filename, pool);
+  *this = std::move(graph);
+}
+
+/**
+ * @brief Loads a graph file into this empty graph, in any of the formats
+ * of LoadGraphFromFile.
+ *
+ * @param filename
+ * @param pool Worker pool for parsing large files, or null.
+ */
+void Graph::Load(const std::string& filename, ThreadPool* pool) {
+  const auto file = std::make_shared<const MappedFile>(filename);
+  if (IsBinaryGraph(file->Data(), file->Size())) {
+    LoadBinary(file);
+    return;
+  }
+  const char* ch = file->Data();
+  const char* const end = ch + file->Size();
+  while (ch != end and IsSpace(*ch)) ++ch;
+  if (ch != end and IsAlpha(*ch)) {
+    LoadCoordinates(ch, end);
+    return;
+  }
+  int vertex_cnt = 0;
+  const auto [ptr, ec] = std::from_chars(ch, end, vertex_cnt);
+  if (ec != std::errc() or ptr == end or *ptr != '\n' or vertex_cnt <= 0) {
     throw std::logic_error("Graph size error");
   }
   CreateGraph(vertex_cnt);
-  for (int i = 0; i < vertex_cnt; ++i) {
-    for (int j = 0; j < vertex_cnt; ++j) {
-      if (file.peek() == EOF) {
-        throw std::logic_error("Count of edge less than shape of graph");
+
+  const size_t bytes = end - ptr;
+  const size_t parts =
+      pool and bytes >= kParallelParseBytes ? pool->Size() * 4 : 1;
+  const auto bounds = SplitAtSpaces(ptr, end, parts);
+  std::vector<size_t> firsts(parts + 1);
+  if (parts > 1) {
+    pool->ParallelFor(
+        parts,
+        [&](size_t from, size_t to) {
+          for (size_t i = from; i < to; ++i) {
+            firsts[i + 1] = CountTokens(bounds[i], bounds[i + 1]);
+          }
+        },
+        1);
+    std::partial_sum(firsts.begin(), firsts.end(), firsts.begin());
+  }
+
+  std::vector<ParsedChunk> chunks(parts);
+  const auto parse = [&](size_t from, size_t to) {
+    for (size_t i = from; i < to; ++i) {
+      chunks[i] = ParseWeights(bounds[i], bounds[i + 1], firsts[i], graph_);
+    }
+  };
+  parts > 1 ? pool->ParallelFor(parts, parse, 1) : parse(0, 1);
+
+  size_t tokens = 0;
+  for (const auto& chunk : chunks) {
+    if (chunk.non_digit) {
+      throw std::logic_error("Non-digit edge weights in graph");
+    }
+    if (chunk.out_of_range) {
+      throw std::logic_error("Edge weight out of range in graph");
+    }
+    tokens += chunk.tokens;
+  }
+  const size_t total = graph_.Rows() * graph_.Cols();
+  if (tokens < total) {
+    throw std::logic_error("Count of edge less than shape of graph");
+  }
+  if (tokens > total) {
+    throw std::logic_error("Count of edge greater than shape of graph");
+  }
+
+  symmetric_ = true;
+  for (int i = 0; i < vertex_cnt and symmetric_; ++i) {
+    for (int j = i + 1; j < vertex_cnt and symmetric_; ++j) {
+      symmetric_ = graph_(i, j) == graph_(j, i);
+    }
+  }
+  CompressIfSparse();
+  BuildCandidateLists(kCandidateCount);
+}
+
+/**
+ * @brief Replaces the weight matrix with compressed sparse rows if fewer
+ * than kSparseDensity of the vertex pairs are connected, so that memory and
+ * the work of choosing the next vertex are proportional to the number of
+ * edges.
+ *
+ */
+void Graph::CompressIfSparse() {
+  const size_t vertex_cnt = graph_.Rows();
+  size_t edges = 0;
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    const int* row = graph_.Row(i);
+    for (size_t j = 0; j < vertex_cnt; ++j) {
+      edges += i != j and row[j] != 0;
+    }
+  }
+  if (vertex_cnt < 2 or
+      edges >= kSparseDensity * vertex_cnt * (vertex_cnt - 1)) {
+    return;
+  }
+
+  offsets_.assign(vertex_cnt + 1, 0);
+  neighbors_.reserve(edges);
+  weights_.reserve(edges);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    const int* row = graph_.Row(i);
+    for (size_t j = 0; j < vertex_cnt; ++j) {
+      if (i != j and row[j] != 0) {
+        neighbors_.push_back(j);
+        weights_.push_back(row[j]);
       }
-      std::string str;
-      std::stringstream sstr;
-      int value;
-      file >> str;
-      if (!std::all_of(str.begin(), str.end(), [](char ch) {
-            return std::isdigit(static_cast<unsigned char>(ch));
-          })) {
-        throw std::logic_error("Non-digit edge weights in graph");
+    }
+    offsets_[i + 1] = neighbors_.size();
+  }
+  reverse_edges_.resize(edges);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    for (size_t edge = offsets_[i]; edge < offsets_[i + 1]; ++edge) {
+      reverse_edges_[edge] = GetEdgeIndex(neighbors_[edge], i);
+    }
+  }
+  graph_ = Matrix();
+  storage_ = Storage::kSparse;
+}
+
+/**
+ * @brief Uses a mapped file in the binary format as the storage of the graph
+ * and its candidate lists, without copying or parsing the weights. The
+ * mapping stays alive as long as the graph or any copy of its matrices.
+ * The checksum of the header is verified in one pass over the file, so a
+ * corrupted file is rejected instead of solved; candidate lists are also
+ * checked in O(n * k), since they index the weights.
+ *
+ * @param file
+ */
+void Graph::LoadBinary(std::shared_ptr<const MappedFile> file) {
+  BinaryGraphHeader header;
+  std::memcpy(&header, file->Data(), sizeof(header));
+  const size_t size = header.size;
+  const size_t stride = Matrix::PaddedStride(size);
+  const size_t candidate_stride =
+      Matrix::PaddedStride(header.candidate_count);
+  if (header.version != kBinaryGraphVersion or
+      header.weight_type != kBinaryGraphInt32 or size == 0 or
+      size > INT_MAX or size > file->Size() / size or header.stride != stride or
+      header.candidate_count >= size or
+      header.candidate_stride != candidate_stride or
+      file->Size() != sizeof(header) + size * (stride + candidate_stride + 1) *
+                                            sizeof(int)) {
+    throw std::logic_error("Binary graph header error");
+  }
+  if (BinaryGraphChecksum(file->Data() + sizeof(header),
+                          file->Size() - sizeof(header)) != header.checksum) {
+    throw std::logic_error("Binary graph checksum error");
+  }
+
+  const char* weights = file->Data() + sizeof(header);
+  const char* candidates = weights + size * stride * sizeof(int);
+  const char* counts = candidates + size * candidate_stride * sizeof(int);
+  candidate_cnt_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    uint32_t count;
+    std::memcpy(&count, counts + i * sizeof(count), sizeof(count));
+    if (count > header.candidate_count) {
+      throw std::logic_error("Binary graph data error");
+    }
+    const char* row = candidates + i * candidate_stride * sizeof(int);
+    for (size_t k = 0; k < count; ++k) {
+      int candidate;
+      std::memcpy(&candidate, row + k * sizeof(int), sizeof(int));
+      if (candidate < 0 or static_cast<size_t>(candidate) >= size or
+          static_cast<size_t>(candidate) == i) {
+        throw std::logic_error("Binary graph data error");
       }
-      sstr << str;
-      sstr >> value;
-      graph_[i][j] = value;
     }
+    candidate_cnt_[i] = count;
   }
-  if (file.peek() != EOF) {
-    throw std::logic_error("Count of edge greater than shape of graph");
+  graph_ =
+      Matrix::View(reinterpret_cast<const int*>(weights), size, size, file);
+  candidates_ = Matrix::View(reinterpret_cast<const int*>(candidates), size,
+                             header.candidate_count, file);
+  symmetric_ = header.flags & kBinaryGraphSymmetric;
+  CacheCandidateWeights();
+}
+
+/**
+ * @brief Loads a TSPLIB file with EUC_2D node coordinates. Only the
+ * coordinates and the candidate edges are stored, so the graph takes memory
+ * linear in the number of vertices and weights are computed when they are
+ * needed.
+ *
+ * @param begin The first character of the file.
+ * @param end The character past the end of the file.
+ */
+void Graph::LoadCoordinates(const char* begin, const char* end) {
+  long long vertex_cnt = 0;
+  bool euclidean = false;
+  const char* ch = begin;
+  while (true) {
+    if (ch == end) throw std::logic_error("Graph size error");
+    const char* line_end = std::find(ch, end, '\n');
+    const std::string_view line(ch, line_end - ch);
+    ch = line_end == end ? end : line_end + 1;
+    const size_t colon = line.find(':');
+    const std::string_view key = Trim(line.substr(0, colon));
+    const std::string_view value =
+        colon == std::string_view::npos ? "" : Trim(line.substr(colon + 1));
+    if (key == "NODE_COORD_SECTION") break;
+    if (key == "DIMENSION" and !ParseNumber(value, vertex_cnt)) {
+      throw std::logic_error("Graph size error");
+    }
+    if (key == "EDGE_WEIGHT_TYPE") euclidean = value == "EUC_2D";
+    if (key == "EDGE_WEIGHT_SECTION" or key == "EOF") break;
+  }
+  if (!euclidean) throw std::logic_error("Unsupported edge weight type");
+  if (vertex_cnt <= 0 or vertex_cnt > INT_MAX) {
+    throw std::logic_error("Graph size error");
+  }
+
+  graph_ = Matrix();
+  storage_ = Storage::kCoordinates;
+  xs_.assign(vertex_cnt, 0.0);
+  ys_.assign(vertex_cnt, 0.0);
+  std::vector<bool> seen(vertex_cnt);
+  for (long long i = 0; i < vertex_cnt; ++i) {
+    const std::string_view id = NextToken(ch, end);
+    if (id.empty() or id == "EOF") {
+      throw std::logic_error("Count of coordinates less than size of graph");
+    }
+    long long index = 0;
+    double x = 0.0;
+    double y = 0.0;
+    if (!ParseNumber(id, index) or !ParseNumber(NextToken(ch, end), x) or
+        !ParseNumber(NextToken(ch, end), y)) {
+      throw std::logic_error("Non-numeric coordinates in graph");
+    }
+    if (index < 1 or index > vertex_cnt or seen[index - 1]) {
+      throw std::logic_error("Coordinate index error");
+    }
+    seen[index - 1] = true;
+    xs_[index - 1] = x;
+    ys_[index - 1] = y;
+  }
+  const std::string_view rest = NextToken(ch, end);
+  if (!rest.empty() and rest != "EOF") {
+    throw std::logic_error("Count of coordinates greater than size of graph");
+  }
+  symmetric_ = true;
+  BuildCandidateLists(kCandidateCount);
+}
+
+/**
+ * @brief Saves the graph with its candidate lists in the binary format
+ *
+ * @param filename
+ */
+void Graph::SaveGraphToBinary(const std::string& filename) const {
+  const size_t size = Size();
+  BinaryGraphHeader header{};
+  std::copy(std::begin(kBinaryGraphMagic), std::end(kBinaryGraphMagic),
+            header.magic);
+  header.version = kBinaryGraphVersion;
+  header.weight_type = kBinaryGraphInt32;
+  header.size = size;
+  header.stride = Matrix::PaddedStride(size);
+  header.candidate_count = candidates_.Cols();
+  header.candidate_stride = candidates_.Stride();
+  header.flags = symmetric_ ? kBinaryGraphSymmetric : 0;
+
+  std::string payload;
+  const auto append = [&payload](const void* data, size_t bytes) {
+    payload.append(static_cast<const char*>(data), bytes);
+  };
+  std::vector<int> row(header.stride);
+  for (size_t i = 0; i < size; ++i) {
+    GetWeightRow(i, row.data());
+    append(row.data(), row.size() * sizeof(int));
+  }
+  append(candidates_.Data(), size * candidates_.Stride() * sizeof(int));
+  for (size_t i = 0; i < size; ++i) {
+    const uint32_t count = candidate_cnt_[i];
+    append(&count, sizeof(count));
+  }
+  header.checksum = BinaryGraphChecksum(payload.data(), payload.size());
+
+  std::ofstream file(filename, std::ios::binary);
+  if (!file) throw std::logic_error("Open file error");
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(payload.data(), payload.size());
+  if (!file) throw std::logic_error("Write file error");
+}
+
+/**
+ * @brief Builds lists of the nearest neighbors of every vertex. Missing edges
+ * (zero weights) are never included, so a list can be shorter than count.
+ * Lists are sorted by weight, then by vertex index. The weights of the listed
+ * edges are cached next to the lists. Coordinate graphs also store the listed
+ * edges as compressed rows, which is where AntAlgorithm keeps their
+ * pheromones.
+ *
+ * @param count Maximum length of every list
+ */
+void Graph::BuildCandidateLists(size_t count) {
+  const size_t vertex_cnt = Size();
+  count = std::min(count, vertex_cnt ? vertex_cnt - 1 : 0);
+  candidates_ = Matrix(vertex_cnt, count, -1);
+  candidate_cnt_.assign(vertex_cnt, 0);
+  if (storage_ == Storage::kCoordinates) {
+    BuildGridCandidateLists(count);
+    CompressCandidateEdges();
+  } else if (storage_ == Storage::kSparse) {
+    BuildSparseCandidateLists(count);
+  } else {
+    BuildMatrixCandidateLists(count);
+  }
+  CacheCandidateWeights();
+}
+
+/**
+ * @brief Rebuilds the candidate lists with up to count nearest neighbors if
+ * they are shorter, so that the candidates parameter is not limited by the
+ * kCandidateCount lists built on load. Longer lists are kept as they are.
+ *
+ * @param count Requested length of every list
+ */
+void Graph::ExtendCandidateLists(size_t count) {
+  const size_t length = candidates_.Cols();
+  if (count <= length or length + 1 >= Size()) return;
+  BuildCandidateLists(count);
+}
+
+/**
+ * @brief Fills candidate lists by scanning every row of the weight matrix
+ *
+ * @param count Maximum length of every list
+ */
+void Graph::BuildMatrixCandidateLists(size_t count) {
+  const size_t vertex_cnt = Size();
+  std::vector<int> neighbors;
+  neighbors.reserve(vertex_cnt);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    neighbors.clear();
+    for (size_t j = 0; j < vertex_cnt; ++j) {
+      if (i != j and graph_(i, j)) neighbors.push_back(j);
+    }
+    const size_t length = std::min(count, neighbors.size());
+    std::partial_sort(neighbors.begin(), neighbors.begin() + length,
+                      neighbors.end(), [this, i](int a, int b) {
+                        return graph_(i, a) < graph_(i, b) or
+                               (graph_(i, a) == graph_(i, b) and a < b);
+                      });
+    std::copy_n(neighbors.begin(), length, candidates_.Row(i));
+    candidate_cnt_[i] = length;
+  }
+}
+
+/**
+ * @brief Fills candidate lists of a coordinate graph without computing all
+ * pairwise distances. Points are bucketed into a uniform grid of about two
+ * points per cell, and every vertex scans rings of cells around its own until
+ * no unscanned point can be closer than the farthest candidate found.
+ *
+ * @param count Maximum length of every list
+ */
+void Graph::BuildGridCandidateLists(size_t count) {
+  const size_t vertex_cnt = Size();
+  if (count == 0) return;
+  const auto [min_x, max_x] = std::minmax_element(xs_.begin(), xs_.end());
+  const auto [min_y, max_y] = std::minmax_element(ys_.begin(), ys_.end());
+  const double left = *min_x;
+  const double bottom = *min_y;
+  const long side = std::max(1L, std::lround(std::sqrt(vertex_cnt / 2.0)));
+  double cell = std::max(*max_x - left, *max_y - bottom) / side;
+  if (cell <= 0.0) cell = 1.0;
+
+  const auto cell_of = [&](double coordinate, double origin) {
+    return std::min<long>(side - 1, (coordinate - origin) / cell);
+  };
+  std::vector<size_t> cell_start(side * side + 1);
+  std::vector<int> cell_points(vertex_cnt);
+  std::vector<size_t> cell_index(vertex_cnt);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    cell_index[i] = cell_of(ys_[i], bottom) * side + cell_of(xs_[i], left);
+    ++cell_start[cell_index[i] + 1];
+  }
+  std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+  std::vector<size_t> fill(cell_start.begin(), cell_start.end() - 1);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    cell_points[fill[cell_index[i]]++] = i;
+  }
+
+  using Neighbor = std::pair<int, int>;
+  std::vector<Neighbor> heap;
+  heap.reserve(count + 1);
+  const auto scan_cell = [&](size_t i, long x, long y) {
+    if (x < 0 or y < 0 or x >= side or y >= side) return;
+    const size_t c = y * side + x;
+    for (size_t k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+      const int j = cell_points[k];
+      if (static_cast<size_t>(j) == i) continue;
+      const int weight = GetWeightUnchecked(i, j);
+      if (heap.size() == count and Neighbor(weight, j) >= heap.front()) {
+        continue;
+      }
+      heap.emplace_back(weight, j);
+      std::push_heap(heap.begin(), heap.end());
+      if (heap.size() > count) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+      }
+    }
+  };
+
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    heap.clear();
+    const long cx = cell_index[i] % side;
+    const long cy = cell_index[i] / side;
+    for (long ring = 0;; ++ring) {
+      for (long x = cx - ring; x <= cx + ring; ++x) {
+        scan_cell(i, x, cy - ring);
+        if (ring) scan_cell(i, x, cy + ring);
+      }
+      for (long y = cy - ring + 1; y < cy + ring; ++y) {
+        scan_cell(i, cx - ring, y);
+        scan_cell(i, cx + ring, y);
+      }
+      if (cx - ring <= 0 and cy - ring <= 0 and cx + ring >= side - 1 and
+          cy + ring >= side - 1) {
+        break;
+      }
+      const double reach = std::min(
+          {xs_[i] - (left + (cx - ring) * cell),
+           left + (cx + ring + 1) * cell - xs_[i],
+           ys_[i] - (bottom + (cy - ring) * cell),
+           bottom + (cy + ring + 1) * cell - ys_[i]});
+      if (heap.size() == count and heap.front().first + 0.5 < reach) break;
+    }
+    std::sort_heap(heap.begin(), heap.end());
+    for (size_t k = 0; k < heap.size(); ++k) {
+      candidates_(i, k) = heap[k].second;
+    }
+    candidate_cnt_[i] = heap.size();
+  }
+}
+
+/**
+ * @brief Fills candidate lists of a sparse graph from the edges of every
+ * vertex
+ *
+ * @param count Maximum length of every list
+ */
+void Graph::BuildSparseCandidateLists(size_t count) {
+  const size_t vertex_cnt = Size();
+  std::vector<int> order;
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    const int* neighbors = GetNeighbors(i);
+    const int* weights = GetNeighborWeights(i);
+    order.resize(GetNeighborCount(i));
+    std::iota(order.begin(), order.end(), 0);
+    const size_t length = std::min(count, order.size());
+    std::partial_sort(order.begin(), order.begin() + length, order.end(),
+                      [weights](int a, int b) {
+                        return weights[a] < weights[b] or
+                               (weights[a] == weights[b] and a < b);
+                      });
+    for (size_t k = 0; k < length; ++k) {
+      candidates_(i, k) = neighbors[order[k]];
+    }
+    candidate_cnt_[i] = length;
+  }
+}
+
+/**
+ * @brief Stores the candidate edges of a coordinate graph as compressed rows
+ * sorted by vertex, each with the index of the opposite edge. An edge is
+ * kept in both directions if either end lists the other as a candidate, so
+ * every edge has its opposite and pheromones stay symmetric.
+ *
+ */
+void Graph::CompressCandidateEdges() {
+  const size_t vertex_cnt = Size();
+  std::vector<std::pair<int, int>> edges;
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    for (size_t k = 0; k < candidate_cnt_[i]; ++k) {
+      edges.emplace_back(i, candidates_(i, k));
+      edges.emplace_back(candidates_(i, k), i);
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  offsets_.assign(vertex_cnt + 1, 0);
+  neighbors_.resize(edges.size());
+  weights_.resize(edges.size());
+  reverse_edges_.resize(edges.size());
+  for (size_t edge = 0; edge < edges.size(); ++edge) {
+    ++offsets_[edges[edge].first + 1];
+    neighbors_[edge] = edges[edge].second;
+  }
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    offsets_[i + 1] += offsets_[i];
+  }
+  for (size_t edge = 0; edge < edges.size(); ++edge) {
+    const auto [i, j] = edges[edge];
+    weights_[edge] = GetWeightUnchecked(i, j);
+    reverse_edges_[edge] = GetEdgeIndex(j, i);
+  }
+}
+
+/**
+ * @brief Stores the weights of the edges to the candidates of every vertex,
+ * so that searches over candidate lists do not touch the weight matrix or
+ * recompute distances. Graphs with compressed rows also store the edge
+ * indices.
+ *
+ */
+void Graph::CacheCandidateWeights() {
+  const size_t vertex_cnt = Size();
+  const bool compressed = HasCompressedRows();
+  candidate_weights_ = Matrix(vertex_cnt, candidates_.Cols());
+  candidate_edges_ =
+      Matrix(compressed ? vertex_cnt : 0, candidates_.Cols(), -1);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    for (size_t k = 0; k < candidate_cnt_[i]; ++k) {
+      const int candidate = candidates_(i, k);
+      candidate_weights_(i, k) = GetWeightUnchecked(i, candidate);
+      if (compressed) candidate_edges_(i, k) = GetEdgeIndex(i, candidate);
+    }
   }
-  file.close();
 }
 
 /**
@@ -45,15 +689,107 @@ void Graph::LoadGraphFromFile(const std::string& filename) {
  * @param size
  */
 void Graph::CreateGraph(const int& size) {
-  this->graph_ = Matrix(size, std::vector<int>(size));
+  this->graph_ = Matrix(size, size);
 }
 
 /**
- * @brief Returns graph member
+ * @brief Returns the weight matrix. Only graphs stored as a matrix have one;
+ * use GetWeightRow or GetWeight for the others.
  *
  * @return const Graph::Matrix&
+ * @throw std::logic_error if the graph is stored as coordinates or sparse
+ * rows.
+ */
+const Graph::Matrix& Graph::GetGraph() const {
+  if (storage_ != Storage::kMatrix) {
+    throw std::logic_error("Graph is not stored as a matrix");
+  }
+  return this->graph_;
+}
+
+/**
+ * @brief Returns number of vertices
+ *
+ * @return size_t
+ */
+size_t Graph::Size() const {
+  if (storage_ == Storage::kCoordinates) return xs_.size();
+  if (storage_ == Storage::kSparse) return offsets_.size() - 1;
+  return graph_.Rows();
+}
+
+/**
+ * @brief Checks if every edge has the same weight in both directions
+ *
+ * @return bool
+ */
+bool Graph::IsSymmetric() const { return symmetric_; }
+
+/**
+ * @brief Checks if the graph is defined by vertex coordinates instead of a
+ * weight matrix
+ *
+ * @return bool
  */
-const Graph::Matrix& Graph::GetGraph() const { return this->graph_; }
+bool Graph::HasCoordinates() const {
+  return storage_ == Storage::kCoordinates;
+}
+
+/**
+ * @brief Checks if the graph keeps only its existing edges in compressed
+ * sparse rows
+ *
+ * @return bool
+ */
+bool Graph::IsSparse() const { return storage_ == Storage::kSparse; }
+
+/**
+ * @brief Checks if the graph keeps edges in compressed rows: all its edges
+ * if it is sparse, its candidate edges if it has coordinates. Per-edge
+ * state of such graphs can follow those rows instead of a dense matrix.
+ *
+ * @return bool
+ */
+bool Graph::HasCompressedRows() const {
+  return storage_ != Storage::kMatrix;
+}
+
+/**
+ * @brief Returns how edge weights are stored
+ *
+ * @return Graph::Storage
+ */
+Graph::Storage Graph::GetStorage() const { return storage_; }
+
+/**
+ * @brief Returns the number of edges in the compressed rows
+ *
+ * @return size_t
+ */
+size_t Graph::GetEdgeCount() const { return neighbors_.size(); }
+
+/**
+ * @brief Writes the weights of all edges leaving vertex to row, computing
+ * whole rows of coordinate graphs with the vectorized distance kernel
+ *
+ * @param vertex
+ * @param row Room for Size() weights
+ */
+void Graph::GetWeightRow(size_t vertex, int* row) const {
+  if (storage_ == Storage::kMatrix) {
+    std::copy_n(graph_.Row(vertex), Size(), row);
+    return;
+  }
+  if (storage_ == Storage::kSparse) {
+    std::fill_n(row, Size(), 0);
+    for (size_t k = 0; k < GetNeighborCount(vertex); ++k) {
+      row[GetNeighbors(vertex)[k]] = GetNeighborWeights(vertex)[k];
+    }
+    return;
+  }
+  GetRowKernels().distance(xs_[vertex], ys_[vertex], xs_.data(), ys_.data(),
+                           row, Size());
+}
 
 /**
  * @brief Returns weigth at (vertex1, vertex2) coordinate
@@ -63,8 +799,8 @@ const Graph::Matrix& Graph::GetGraph() const { return this->graph_; }
  * @return int
  */
 int Graph::GetWeight(int idx1, int idx2) const {
-  if ((idx1 < 0 or idx1 >= static_cast<int>(graph_.size())) or
-      (idx2 < 0 or idx2 >= static_cast<int>(graph_.size())))
+  if ((idx1 < 0 or idx1 >= static_cast<int>(Size())) or
+      (idx2 < 0 or idx2 >= static_cast<int>(Size())))
     throw std::out_of_range("Graph index out of range");
-  return graph_[idx1][idx2];
+  return GetWeightUnchecked(idx1, idx2);
 }
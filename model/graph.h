@@ -2,25 +2,177 @@
 #define SRC_ANT_GRAPH_H
 
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "kernels.h"
+#include "matrix.h"
+
+class MappedFile;
+class ThreadPool;
+
 class Graph {
  public:
-  using Matrix = std::vector<std::vector<int>>;
+  using Matrix = ::Matrix<int>;
+
+  /**
+   * @brief How edge weights are stored: a dense matrix, vertex coordinates,
+   * or compressed sparse rows of the existing edges. Coordinate graphs also
+   * keep their candidate edges in compressed rows.
+   */
+  enum class Storage { kMatrix, kCoordinates, kSparse };
+
+  static constexpr size_t kCandidateCount = 20;
+  static constexpr double kSparseDensity = 0.1;
 
-  void LoadGraphFromFile(const std::string& filename);
+  void LoadGraphFromFile(const std::string& filename,
+                         ThreadPool* pool = nullptr);
+  void SaveGraphToBinary(const std::string& filename) const;
+  void BuildCandidateLists(size_t count);
+  void ExtendCandidateLists(size_t count);
 
   const Matrix& GetGraph() const;
+  size_t Size() const;
+  bool IsSymmetric() const;
+  bool HasCoordinates() const;
+  bool IsSparse() const;
+  bool HasCompressedRows() const;
+  Storage GetStorage() const;
+  size_t GetEdgeCount() const;
   int GetWeight(int vertex1, int vertex2) const;
+  void GetWeightRow(size_t vertex, int* row) const;
+
+  /**
+   * @brief Returns weight at (vertex1, vertex2) without bounds checking.
+   * Coordinate graphs compute it on the fly, sparse graphs look it up.
+   */
+  int GetWeightUnchecked(size_t vertex1, size_t vertex2) const {
+    if (storage_ == Storage::kMatrix) return graph_(vertex1, vertex2);
+    if (storage_ == Storage::kCoordinates) {
+      return EuclideanDistance(xs_[vertex1], ys_[vertex1], xs_[vertex2],
+                               ys_[vertex2]);
+    }
+    const long edge = GetEdgeIndex(vertex1, vertex2);
+    return edge < 0 ? 0 : weights_[edge];
+  }
+
+  /**
+   * @brief Checks if there is an edge from vertex1 to vertex2. Any two
+   * points of a coordinate graph are joined, even at zero distance; in the
+   * other formats a zero weight means a missing edge.
+   */
+  bool HasEdge(size_t vertex1, size_t vertex2) const {
+    if (vertex1 == vertex2) return false;
+    if (storage_ == Storage::kCoordinates) return true;
+    return GetWeightUnchecked(vertex1, vertex2) != 0;
+  }
+
+  /**
+   * @brief Returns the index of edge (vertex1, vertex2) in the compressed
+   * rows, or -1 if they do not hold it
+   */
+  long GetEdgeIndex(size_t vertex1, size_t vertex2) const {
+    const int* first = neighbors_.data() + offsets_[vertex1];
+    const int* last = neighbors_.data() + offsets_[vertex1 + 1];
+    const int* found = std::lower_bound(first, last, vertex2);
+    return found != last and static_cast<size_t>(*found) == vertex2
+               ? found - neighbors_.data()
+               : -1;
+  }
+
+  /**
+   * @brief Returns the index of edge (vertex2, vertex1) in the compressed
+   * rows given the index of edge (vertex1, vertex2), or -1 if they do not
+   * hold it
+   */
+  long GetReverseEdge(size_t edge) const { return reverse_edges_[edge]; }
+
+  /**
+   * @brief Returns the index of the first edge of vertex in the compressed
+   * rows
+   */
+  size_t GetNeighborOffset(size_t vertex) const { return offsets_[vertex]; }
+
+  /**
+   * @brief Returns the vertices adjacent to vertex in the compressed rows, in
+   * ascending order: all neighbors in a sparse graph, the candidates in a
+   * coordinate graph
+   */
+  const int* GetNeighbors(size_t vertex) const {
+    return neighbors_.data() + offsets_[vertex];
+  }
+
+  /**
+   * @brief Returns the weights of the edges leaving vertex in the compressed
+   * rows
+   */
+  const int* GetNeighborWeights(size_t vertex) const {
+    return weights_.data() + offsets_[vertex];
+  }
+
+  /**
+   * @brief Returns the number of edges leaving vertex in the compressed rows
+   */
+  size_t GetNeighborCount(size_t vertex) const {
+    return offsets_[vertex + 1] - offsets_[vertex];
+  }
+
+  /**
+   * @brief Returns nearest neighbors of vertex sorted by edge weight
+   */
+  const int* GetCandidates(size_t vertex) const {
+    return candidates_.Row(vertex);
+  }
+
+  /**
+   * @brief Returns length of the candidate list of vertex
+   */
+  size_t GetCandidateCount(size_t vertex) const {
+    return candidate_cnt_[vertex];
+  }
+
+  /**
+   * @brief Returns cached weights of the edges to the candidates of vertex
+   */
+  const int* GetCandidateWeights(size_t vertex) const {
+    return candidate_weights_.Row(vertex);
+  }
+
+  /**
+   * @brief Returns edge indices of the candidates of vertex in the compressed
+   * rows
+   */
+  const int* GetCandidateEdges(size_t vertex) const {
+    return candidate_edges_.Row(vertex);
+  }
 
  private:
+  void Load(const std::string& filename, ThreadPool* pool);
   void CreateGraph(const int& size);
+  void LoadBinary(std::shared_ptr<const MappedFile> file);
+  void LoadCoordinates(const char* begin, const char* end);
+  void CompressIfSparse();
+  void BuildMatrixCandidateLists(size_t count);
+  void BuildGridCandidateLists(size_t count);
+  void BuildSparseCandidateLists(size_t count);
+  void CompressCandidateEdges();
+  void CacheCandidateWeights();
 
  private:
+  Storage storage_ = Storage::kMatrix;
   Matrix graph_;
+  std::vector<double> xs_;
+  std::vector<double> ys_;
+  std::vector<size_t> offsets_;
+  std::vector<int> neighbors_;
+  std::vector<int> weights_;
+  std::vector<long> reverse_edges_;
+  Matrix candidates_;
+  Matrix candidate_weights_;
+  Matrix candidate_edges_;
+  std::vector<size_t> candidate_cnt_;
+  bool symmetric_ = false;
 };
 
 #endif  // SRC_ANT_GRAPH_H
@@ -0,0 +1,183 @@
+#include "heuristics.h"
+
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+
+#include "exact_solver.h"
+
+namespace {
+
+template <typename T>
+T ParseValue(const std::string &key, const std::string &value) {
+  T result{};
+  const char *end = value.data() + value.size();
+  const auto [ptr, ec] = std::from_chars(value.data(), end, result);
+  if (ec != std::errc() or ptr != end or value.empty()) {
+    throw std::logic_error("Invalid value of parameter " + key);
+  }
+  return result;
+}
+
+std::string Trim(const std::string &str) {
+  const size_t begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) return "";
+  const size_t end = str.find_last_not_of(" \t\r");
+  return str.substr(begin, end - begin + 1);
+}
+
+}  // namespace
+
+/**
+ * @brief Sets one parameter by its name.
+ *
+ * @param key The name of the parameter, the same as the field name.
+ * @param value The new value in text form.
+ * @throw std::logic_error on unknown key or malformed value.
+ */
+void Heuristics::Set(const std::string &key, const std::string &value) {
+  if (key == "alpha") {
+    alpha = ParseValue<double>(key, value);
+  } else if (key == "beta") {
+    beta = ParseValue<double>(key, value);
+  } else if (key == "q") {
+    q = ParseValue<double>(key, value);
+  } else if (key == "tau") {
+    tau = ParseValue<double>(key, value);
+  } else if (key == "ro") {
+    ro = ParseValue<double>(key, value);
+  } else if (key == "colonies") {
+    colonies = ParseValue<size_t>(key, value);
+  } else if (key == "ants") {
+    ants = ParseValue<size_t>(key, value);
+  } else if (key == "bypass_count") {
+    bypass_count = ParseValue<size_t>(key, value);
+  } else if (key == "candidates") {
+    candidates = ParseValue<size_t>(key, value);
+  } else if (key == "islands") {
+    islands = ParseValue<size_t>(key, value);
+  } else if (key == "migration_interval") {
+    migration_interval = ParseValue<size_t>(key, value);
+  } else if (key == "update") {
+    if (value == "classic") {
+      update = PheromoneUpdate::kClassic;
+    } else if (value == "mmas") {
+      update = PheromoneUpdate::kMaxMin;
+    } else if (value == "acs") {
+      update = PheromoneUpdate::kAntColonySystem;
+    } else {
+      throw std::logic_error("Invalid value of parameter " + key);
+    }
+  } else if (key == "q0") {
+    q0 = ParseValue<double>(key, value);
+  } else if (key == "xi") {
+    xi = ParseValue<double>(key, value);
+  } else if (key == "local_search") {
+    if (value == "none") {
+      local_search = LocalSearchMethod::kNone;
+    } else if (value == "2opt") {
+      local_search = LocalSearchMethod::kTwoOpt;
+    } else if (value == "oropt") {
+      local_search = LocalSearchMethod::kOrOpt;
+    } else if (value == "both") {
+      local_search = LocalSearchMethod::kTwoOptOrOpt;
+    } else {
+      throw std::logic_error("Invalid value of parameter " + key);
+    }
+  } else if (key == "local_search_scope") {
+    if (value == "ant") {
+      local_search_scope = LocalSearchScope::kEachAnt;
+    } else if (value == "best") {
+      local_search_scope = LocalSearchScope::kIterationBest;
+    } else {
+      throw std::logic_error("Invalid value of parameter " + key);
+    }
+  } else if (key == "stagnation") {
+    stagnation = ParseValue<size_t>(key, value);
+  } else if (key == "branching") {
+    branching = ParseValue<double>(key, value);
+  } else if (key == "target") {
+    target = ParseValue<double>(key, value);
+  } else if (key == "time_limit") {
+    time_limit = ParseValue<double>(key, value);
+  } else if (key == "bound_iterations") {
+    bound_iterations = ParseValue<size_t>(key, value);
+  } else if (key == "gap") {
+    gap = ParseValue<double>(key, value);
+  } else if (key == "exact_size") {
+    exact_size = ParseValue<size_t>(key, value);
+  } else {
+    throw std::logic_error("Unknown parameter " + key);
+  }
+}
+
+/**
+ * @brief Checks that the parameters make sense for the algorithm.
+ *
+ * @throw std::logic_error naming the first invalid parameter.
+ */
+void Heuristics::Validate() const {
+  if (alpha < 0.0) throw std::logic_error("Parameter alpha is negative");
+  if (beta < 0.0) throw std::logic_error("Parameter beta is negative");
+  if (q <= 0.0) throw std::logic_error("Parameter q is not positive");
+  if (tau <= 0.0) throw std::logic_error("Parameter tau is not positive");
+  if (ro < 0.0 or ro > 1.0) {
+    throw std::logic_error("Parameter ro is out of [0, 1]");
+  }
+  if (ro == 0.0 and update == PheromoneUpdate::kMaxMin) {
+    throw std::logic_error("Parameter ro is zero with update mmas");
+  }
+  if (q0 < 0.0 or q0 > 1.0) {
+    throw std::logic_error("Parameter q0 is out of [0, 1]");
+  }
+  if (xi < 0.0 or xi > 1.0) {
+    throw std::logic_error("Parameter xi is out of [0, 1]");
+  }
+  if (branching < 0.0) {
+    throw std::logic_error("Parameter branching is negative");
+  }
+  if (target < 0.0) throw std::logic_error("Parameter target is negative");
+  if (time_limit < 0.0) {
+    throw std::logic_error("Parameter time_limit is negative");
+  }
+  if (gap < 0.0) throw std::logic_error("Parameter gap is negative");
+  if (gap > 0.0 and bound_iterations == 0) {
+    throw std::logic_error("Parameter gap needs bound_iterations");
+  }
+  if (exact_size > ExactSolver::kMaxSize) {
+    throw std::logic_error("Parameter exact_size is greater than " +
+                           std::to_string(ExactSolver::kMaxSize));
+  }
+  if (colonies == 0) throw std::logic_error("Parameter colonies is zero");
+  if (bypass_count == 0) {
+    throw std::logic_error("Parameter bypass_count is zero");
+  }
+  if (migration_interval == 0) {
+    throw std::logic_error("Parameter migration_interval is zero");
+  }
+}
+
+/**
+ * @brief Loads parameters from a file of "key = value" lines. Empty lines and
+ * lines starting with '#' are skipped; missing keys keep their defaults.
+ *
+ * @param filename
+ * @return Heuristics
+ */
+Heuristics Heuristics::LoadFromFile(const std::string &filename) {
+  std::ifstream file(filename);
+  if (!file) throw std::logic_error("Open file error");
+  Heuristics heuristics;
+  std::string line;
+  while (std::getline(file, line)) {
+    line = Trim(line);
+    if (line.empty() or line.front() == '#') continue;
+    const size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+      throw std::logic_error("Parameter line without '=': " + line);
+    }
+    heuristics.Set(Trim(line.substr(0, eq)), Trim(line.substr(eq + 1)));
+  }
+  heuristics.Validate();
+  return heuristics;
+}
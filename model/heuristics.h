@@ -1,18 +1,58 @@
 #ifndef SRC_ANT_HEURISTICS_H
 #define SRC_ANT_HEURISTICS_H
 
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Pheromone update rules: the original reinforcement of every ant's
+ * tour, MAX-MIN Ant System and Ant Colony System.
+ *
+ */
+enum class PheromoneUpdate { kClassic, kMaxMin, kAntColonySystem };
+
 /**
- * @brief Hyperparameters for Ant colony optimization algorithm
+ * @brief Local search neighborhoods applied to ant tours, and which tours of
+ * a bypass they improve.
+ *
+ */
+enum class LocalSearchMethod { kNone, kTwoOpt, kOrOpt, kTwoOptOrOpt };
+enum class LocalSearchScope { kEachAnt, kIterationBest };
+
+/**
+ * @brief Hyperparameters for Ant colony optimization algorithm. Defaults can
+ * be overridden at runtime, one key at a time or from a file of "key = value"
+ * lines.
  *
  */
 struct Heuristics {
-  const double kAlpha = 1.0;
-  const double kBeta = 1.0;
-  const double kQ = 4.0;
-  const double kTau = 0.2;
-  const double kRo = 0.5;
-  const size_t kColonies = 100;
-  const size_t kBypassCount = 10;
+  double alpha = 1.0;
+  double beta = 1.0;
+  double q = 4.0;
+  double tau = 0.2;
+  double ro = 0.5;
+  size_t colonies = 100;
+  size_t ants = 0;
+  size_t bypass_count = 10;
+  size_t candidates = 0;
+  size_t islands = 0;
+  size_t migration_interval = 5;
+  PheromoneUpdate update = PheromoneUpdate::kClassic;
+  double q0 = 0.9;
+  double xi = 0.1;
+  LocalSearchMethod local_search = LocalSearchMethod::kNone;
+  LocalSearchScope local_search_scope = LocalSearchScope::kEachAnt;
+  size_t stagnation = 0;
+  double branching = 0.0;
+  double target = 0.0;
+  double time_limit = 0.0;
+  size_t bound_iterations = 0;
+  double gap = 0.0;
+  size_t exact_size = 16;
+
+  void Set(const std::string &key, const std::string &value);
+  void Validate() const;
+  static Heuristics LoadFromFile(const std::string &filename);
 };
 
 #endif  // SRC_ANT_HEURISTICS_H
@@ -0,0 +1,249 @@
+#include "kernels.h"
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define ANT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline bool IsVisited(const uint64_t *tabu, size_t i) {
+  return (tabu[i >> 6] >> (i & 63)) & 1;
+}
+
+inline unsigned TabuBits(const uint64_t *tabu, size_t i, unsigned mask) {
+  return (tabu[i >> 6] >> (i & 63)) & mask;
+}
+
+/**
+ * @brief Scans elements [from, to) of a row, adding unvisited weights to
+ * cumulate until it exceeds target.
+ */
+int SelectTail(const double *row, const uint64_t *tabu, size_t from,
+               size_t to, double target, double &cumulate, int &last) {
+  for (size_t i = from; i < to; ++i) {
+    if (!IsVisited(tabu, i) and row[i] > 0.0) {
+      cumulate += row[i];
+      last = i;
+      if (target < cumulate) return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Returns the last unvisited vertex with positive weight, or -1.
+ */
+int LastPositive(const double *row, const uint64_t *tabu, size_t size) {
+  for (size_t i = size; i-- > 0;) {
+    if (!IsVisited(tabu, i) and row[i] > 0.0) return i;
+  }
+  return -1;
+}
+
+double ScalarRowSum(const double *row, const uint64_t *tabu, size_t size) {
+  double total = 0.0;
+  for (size_t i = 0; i < size; ++i) {
+    if (!IsVisited(tabu, i)) total += row[i];
+  }
+  return total;
+}
+
+int ScalarRowSelect(const double *row, const uint64_t *tabu, size_t size,
+                    double target) {
+  double cumulate = 0.0;
+  int last = -1;
+  const int found = SelectTail(row, tabu, 0, size, target, cumulate, last);
+  return found != -1 ? found : last;
+}
+
+void ScalarDistanceRow(double x, double y, const double *xs, const double *ys,
+                       int *out, size_t size) {
+  for (size_t j = 0; j < size; ++j) {
+    out[j] = EuclideanDistance(x, y, xs[j], ys[j]);
+  }
+}
+
+#ifdef ANT_X86_KERNELS
+
+/**
+ * @brief Masks of unvisited lanes for every combination of four tabu bits.
+ */
+struct AvxMasks {
+  alignas(32) int64_t lanes[16][4];
+  AvxMasks() {
+    for (int bits = 0; bits < 16; ++bits) {
+      for (int lane = 0; lane < 4; ++lane) {
+        lanes[bits][lane] = (bits >> lane) & 1 ? 0 : -1;
+      }
+    }
+  }
+};
+
+const AvxMasks kAvxMasks;
+
+__attribute__((target("avx2"))) inline __m256d AvxMasked(const double *row,
+                                                         const uint64_t *tabu,
+                                                         size_t i) {
+  const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i *>(
+      kAvxMasks.lanes[TabuBits(tabu, i, 0xF)]));
+  return _mm256_and_pd(_mm256_loadu_pd(row + i), _mm256_castsi256_pd(mask));
+}
+
+__attribute__((target("avx2"))) inline double AvxHorizontalSum(__m256d v) {
+  const __m128d pair =
+      _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2"))) double AvxRowSum(const double *row,
+                                                 const uint64_t *tabu,
+                                                 size_t size) {
+  __m256d acc = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    acc = _mm256_add_pd(acc, AvxMasked(row, tabu, i));
+  }
+  double total = AvxHorizontalSum(acc);
+  for (; i < size; ++i) {
+    if (!IsVisited(tabu, i)) total += row[i];
+  }
+  return total;
+}
+
+__attribute__((target("avx2"))) int AvxRowSelect(const double *row,
+                                                 const uint64_t *tabu,
+                                                 size_t size, double target) {
+  double cumulate = 0.0;
+  int last = -1;
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const double block = AvxHorizontalSum(AvxMasked(row, tabu, i));
+    if (block <= 0.0) continue;
+    if (target < cumulate + block) {
+      const int found = SelectTail(row, tabu, i, i + 4, target, cumulate, last);
+      if (found != -1) return found;
+    } else {
+      cumulate += block;
+      last = i;
+    }
+  }
+  const int found = SelectTail(row, tabu, i, size, target, cumulate, last);
+  if (found != -1) return found;
+  return last == -1 ? -1 : LastPositive(row, tabu, size);
+}
+
+__attribute__((target("sse2"))) double SseRowSum(const double *row,
+                                                 const uint64_t *tabu,
+                                                 size_t size) {
+  alignas(16) static const int64_t kMasks[4][2] = {
+      {-1, -1}, {0, -1}, {-1, 0}, {0, 0}};
+  __m128d acc = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128i mask = _mm_load_si128(
+        reinterpret_cast<const __m128i *>(kMasks[TabuBits(tabu, i, 0x3)]));
+    acc = _mm_add_pd(acc,
+                     _mm_and_pd(_mm_loadu_pd(row + i), _mm_castsi128_pd(mask)));
+  }
+  double total = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+  for (; i < size; ++i) {
+    if (!IsVisited(tabu, i)) total += row[i];
+  }
+  return total;
+}
+
+__attribute__((target("avx2"))) void AvxDistanceRow(double x, double y,
+                                                    const double *xs,
+                                                    const double *ys, int *out,
+                                                    size_t size) {
+  const __m256d px = _mm256_set1_pd(x);
+  const __m256d py = _mm256_set1_pd(y);
+  const __m256d half = _mm256_set1_pd(0.5);
+  size_t j = 0;
+  for (; j + 4 <= size; j += 4) {
+    const __m256d dx = _mm256_sub_pd(px, _mm256_loadu_pd(xs + j));
+    const __m256d dy = _mm256_sub_pd(py, _mm256_loadu_pd(ys + j));
+    const __m256d squared =
+        _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+    const __m256d rounded = _mm256_add_pd(_mm256_sqrt_pd(squared), half);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j),
+                     _mm256_cvttpd_epi32(rounded));
+  }
+  ScalarDistanceRow(x, y, xs + j, ys + j, out + j, size - j);
+}
+
+#endif  // ANT_X86_KERNELS
+
+RowKernels DetectRowKernels() {
+#ifdef ANT_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {AvxRowSum, AvxRowSelect, AvxDistanceRow, "avx2"};
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return {SseRowSum, ScalarRowSelect, ScalarDistanceRow, "sse2"};
+  }
+#endif
+  return {ScalarRowSum, ScalarRowSelect, ScalarDistanceRow, "scalar"};
+}
+
+void GenericChoiceRowKernel(const double *tau, const double *visibility,
+                            double *out, size_t size, double alpha) {
+  for (size_t j = 0; j < size; ++j) {
+    out[j] = std::pow(tau[j], alpha) * visibility[j];
+  }
+}
+
+void GenericVisibilityRowKernel(const int *weight, double *out, size_t size,
+                                double beta) {
+  for (size_t j = 0; j < size; ++j) {
+    out[j] = weight[j] ? std::pow(1.0 / weight[j], beta) : 0.0;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Returns the choice info kernel for alpha. Integer exponents from 0
+ * to 4 get specializations without std::pow.
+ *
+ * @param alpha
+ * @return ChoiceKernel
+ */
+ChoiceKernel SelectChoiceKernel(double alpha) {
+  if (alpha == 0.0) return ChoiceRowKernel<0>;
+  if (alpha == 1.0) return ChoiceRowKernel<1>;
+  if (alpha == 2.0) return ChoiceRowKernel<2>;
+  if (alpha == 3.0) return ChoiceRowKernel<3>;
+  if (alpha == 4.0) return ChoiceRowKernel<4>;
+  return GenericChoiceRowKernel;
+}
+
+/**
+ * @brief Returns the visibility kernel for beta. Integer exponents from 0 to
+ * 5 get specializations without std::pow.
+ *
+ * @param beta
+ * @return VisibilityKernel
+ */
+VisibilityKernel SelectVisibilityKernel(double beta) {
+  if (beta == 0.0) return VisibilityRowKernel<0>;
+  if (beta == 1.0) return VisibilityRowKernel<1>;
+  if (beta == 2.0) return VisibilityRowKernel<2>;
+  if (beta == 3.0) return VisibilityRowKernel<3>;
+  if (beta == 4.0) return VisibilityRowKernel<4>;
+  if (beta == 5.0) return VisibilityRowKernel<5>;
+  return GenericVisibilityRowKernel;
+}
+
+/**
+ * @brief Returns the row kernels for the best instruction set supported by
+ * the CPU, detected on the first call.
+ *
+ * @return const RowKernels&
+ */
+const RowKernels &GetRowKernels() {
+  static const RowKernels kernels = DetectRowKernels();
+  return kernels;
+}
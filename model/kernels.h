@@ -0,0 +1,81 @@
+#ifndef PARALLELS_ANT_MODEL_KERNELS_H_
+#define PARALLELS_ANT_MODEL_KERNELS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Raises x to a power known at compile time with plain multiplies.
+ *
+ * @tparam Exponent Non-negative integer exponent.
+ */
+template <int Exponent>
+inline double Power(double x) {
+  return x * Power<Exponent - 1>(x);
+}
+
+template <>
+inline double Power<0>(double) {
+  return 1.0;
+}
+
+/**
+ * @brief Computes out[j] = tau[j]^alpha * visibility[j] for one row.
+ */
+template <int Alpha>
+void ChoiceRowKernel(const double *tau, const double *visibility, double *out,
+                     size_t size, double) {
+  for (size_t j = 0; j < size; ++j) {
+    out[j] = Power<Alpha>(tau[j]) * visibility[j];
+  }
+}
+
+/**
+ * @brief Computes out[j] = (1 / weight[j])^beta for one row, zero for missing
+ * edges.
+ */
+template <int Beta>
+void VisibilityRowKernel(const int *weight, double *out, size_t size, double) {
+  for (size_t j = 0; j < size; ++j) {
+    out[j] = weight[j] ? Power<Beta>(1.0 / weight[j]) : 0.0;
+  }
+}
+
+using ChoiceKernel = void (*)(const double *, const double *, double *, size_t,
+                              double);
+using VisibilityKernel = void (*)(const int *, double *, size_t, double);
+
+ChoiceKernel SelectChoiceKernel(double alpha);
+VisibilityKernel SelectVisibilityKernel(double beta);
+
+/**
+ * @brief Kernels over one choice info row with the tabu list as a bitmask
+ * (bit i of word i / 64 is set for visited vertex i). Sum returns the total
+ * weight of unvisited vertices; Select returns the first unvisited vertex
+ * whose cumulative weight exceeds target, the last one with positive weight
+ * if rounding leaves target uncovered, or -1 if all weights are zero.
+ * Distance fills a row of Euclidean distances from (x, y) to the points
+ * (xs[j], ys[j]), rounded to the nearest integer as in TSPLIB EUC_2D.
+ */
+struct RowKernels {
+  double (*sum)(const double *row, const uint64_t *tabu, size_t size);
+  int (*select)(const double *row, const uint64_t *tabu, size_t size,
+                double target);
+  void (*distance)(double x, double y, const double *xs, const double *ys,
+                   int *out, size_t size);
+  const char *name;
+};
+
+/**
+ * @brief Returns the TSPLIB EUC_2D distance between two points.
+ */
+inline int EuclideanDistance(double x1, double y1, double x2, double y2) {
+  const double dx = x1 - x2;
+  const double dy = y1 - y2;
+  return static_cast<int>(std::sqrt(dx * dx + dy * dy) + 0.5);
+}
+
+const RowKernels &GetRowKernels();
+
+#endif  // PARALLELS_ANT_MODEL_KERNELS_H_
@@ -0,0 +1,226 @@
+#include "local_search.h"
+
+/**
+ * @brief Constructs a LocalSearch object for the given graph.
+ *
+ * @param graph A reference to the graph whose tours will be improved.
+ */
+LocalSearch::LocalSearch(const Graph &graph) : graph_{graph} {}
+
+/**
+ * @brief Improves a closed tour until no move from the chosen neighborhood
+ * shortens it. Incomplete tours, tours using missing edges and asymmetric
+ * graphs are left untouched.
+ *
+ * @param path Closed tour, the first vertex repeated at the end. It keeps its
+ * first vertex.
+ * @param size The number of vertices in the tour.
+ * @param method Neighborhoods to search.
+ * @return True if the tour has been shortened.
+ */
+bool LocalSearch::Improve(int *path, size_t size, LocalSearchMethod method) {
+  const size_t vertex_cnt = graph_.Size();
+  if (method == LocalSearchMethod::kNone or vertex_cnt < 5 or
+      size != vertex_cnt + 1 or path[0] != path[vertex_cnt] or
+      !graph_.IsSymmetric()) {
+    return false;
+  }
+  for (size_t i = 1; i < size; ++i) {
+    if (!HasEdge(path[i - 1], path[i])) return false;
+  }
+
+  tour_.assign(path, path + vertex_cnt);
+  pos_.resize(vertex_cnt);
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    pos_[tour_[i]] = i;
+  }
+  active_.assign(vertex_cnt, true);
+  queue_.assign(tour_.begin(), tour_.end());
+
+  bool improved = false;
+  while (!queue_.empty()) {
+    const int a = queue_.front();
+    queue_.pop_front();
+    active_[a] = false;
+    if ((method != LocalSearchMethod::kOrOpt and TryTwoOpt(a)) or
+        (method != LocalSearchMethod::kTwoOpt and TryOrOpt(a))) {
+      improved = true;
+    }
+  }
+
+  if (improved) {
+    const size_t start = pos_[path[0]];
+    for (size_t i = 0; i < vertex_cnt; ++i) {
+      path[i] = tour_[(start + i) % vertex_cnt];
+    }
+    path[vertex_cnt] = path[0];
+  }
+  return improved;
+}
+
+/**
+ * @brief Looks for a 2-opt move removing one of the two tour edges at vertex
+ * a and applies the first improving one.
+ *
+ * @param a The vertex whose edges are examined.
+ * @return True if a move has been applied.
+ */
+bool LocalSearch::TryTwoOpt(int a) {
+  const int *candidates = graph_.GetCandidates(a);
+  const int *weights = graph_.GetCandidateWeights(a);
+  const size_t count = graph_.GetCandidateCount(a);
+  for (int forward = 1; forward >= 0; --forward) {
+    const int b = forward ? Next(a) : Prev(a);
+    const long long ab = Weight(a, b);
+    for (size_t k = 0; k < count; ++k) {
+      const int c = candidates[k];
+      const long long ac = weights[k];
+      if (ac >= ab) break;
+      const int d = forward ? Next(c) : Prev(c);
+      if (c == b or d == a or !HasEdge(b, d)) continue;
+      if (ab + Weight(c, d) - ac - Weight(b, d) <= 0) continue;
+
+      const size_t vertex_cnt = tour_.size();
+      const size_t from = forward ? pos_[b] : pos_[a];
+      const size_t to = forward ? pos_[c] : pos_[d];
+      const size_t length = (to + vertex_cnt - from) % vertex_cnt + 1;
+      if (2 * length <= vertex_cnt) {
+        Reverse(from, length);
+      } else {
+        Reverse((to + 1) % vertex_cnt, vertex_cnt - length);
+      }
+      Activate(a);
+      Activate(b);
+      Activate(c);
+      Activate(d);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Looks for an Or-opt move relocating a segment of one to three
+ * vertices that starts or ends at vertex a, and applies the first improving
+ * one.
+ *
+ * @param a The vertex whose segments are examined.
+ * @return True if a move has been applied.
+ */
+bool LocalSearch::TryOrOpt(int a) {
+  const size_t vertex_cnt = tour_.size();
+  for (size_t length = 1; length <= 3 and length + 3 <= vertex_cnt; ++length) {
+    const size_t starts[] = {pos_[a],
+                             (pos_[a] + vertex_cnt - length + 1) % vertex_cnt};
+    for (size_t s = 0; s < (length == 1 ? 1u : 2u); ++s) {
+      const int s1 = tour_[starts[s]];
+      const int s2 = tour_[(starts[s] + length - 1) % vertex_cnt];
+      const int p = Prev(s1);
+      const int nx = Next(s2);
+      if (!HasEdge(p, nx)) continue;
+      const long long gain = Weight(p, s1) + Weight(s2, nx) - Weight(p, nx);
+      if (gain <= 0) continue;
+
+      for (const int e : {s1, s2}) {
+        const int *candidates = graph_.GetCandidates(e);
+        const int *weights = graph_.GetCandidateWeights(e);
+        const size_t count = graph_.GetCandidateCount(e);
+        for (size_t k = 0; k < count; ++k) {
+          const int c = candidates[k];
+          if (weights[k] >= gain) break;
+          for (const int x : {c, Prev(c)}) {
+            const size_t offset =
+                (pos_[x] + vertex_cnt - pos_[s1]) % vertex_cnt;
+            if (offset < length or x == p) continue;
+            if (TryInsertion(s1, s2, length, x, gain)) {
+              Activate(p);
+              Activate(nx);
+              return true;
+            }
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Moves segment s1..s2 between x and its successor, in the better of
+ * the two orientations, if that shortens the tour.
+ *
+ * @param s1 The first vertex of the segment.
+ * @param s2 The last vertex of the segment.
+ * @param length Number of vertices in the segment.
+ * @param x The vertex after which the segment is inserted.
+ * @param gain Length saved by removing the segment from its place.
+ * @return True if the segment has been moved.
+ */
+bool LocalSearch::TryInsertion(int s1, int s2, size_t length, int x,
+                               long long gain) {
+  const int y = Next(x);
+  const long long xy = Weight(x, y);
+  const bool can_keep = HasEdge(x, s1) and HasEdge(s2, y);
+  const bool can_reverse = HasEdge(x, s2) and HasEdge(s1, y);
+  const long long keep = can_keep ? Weight(x, s1) + Weight(s2, y) - xy : gain;
+  const long long reverse =
+      can_reverse ? Weight(x, s2) + Weight(s1, y) - xy : gain;
+  if (std::min(keep, reverse) >= gain) return false;
+
+  const size_t vertex_cnt = tour_.size();
+  const size_t base = pos_[s1];
+  const size_t offset = (pos_[x] + vertex_cnt - base) % vertex_cnt;
+  if (keep <= reverse) Reverse(base, length);
+  Reverse((base + length) % vertex_cnt, offset - length + 1);
+  Reverse(base, offset + 1);
+  Activate(s1);
+  Activate(s2);
+  Activate(x);
+  Activate(y);
+  return true;
+}
+
+/**
+ * @brief Reverses the cyclic run of tour positions starting at from.
+ *
+ * @param from Position of the first vertex of the run.
+ * @param length Number of vertices in the run.
+ */
+void LocalSearch::Reverse(size_t from, size_t length) {
+  const size_t vertex_cnt = tour_.size();
+  for (size_t i = 0; i < length / 2; ++i) {
+    const size_t x = (from + i) % vertex_cnt;
+    const size_t y = (from + length - 1 - i) % vertex_cnt;
+    std::swap(tour_[x], tour_[y]);
+    pos_[tour_[x]] = x;
+    pos_[tour_[y]] = y;
+  }
+}
+
+/**
+ * @brief Clears the don't-look bit of a vertex and queues it for search.
+ *
+ * @param vertex
+ */
+void LocalSearch::Activate(int vertex) {
+  if (!active_[vertex]) {
+    active_[vertex] = true;
+    queue_.push_back(vertex);
+  }
+}
+
+bool LocalSearch::HasEdge(int a, int b) const {
+  return graph_.HasEdge(a, b);
+}
+
+long long LocalSearch::Weight(int a, int b) const {
+  return graph_.GetWeightUnchecked(a, b);
+}
+
+int LocalSearch::Next(int vertex) const {
+  return tour_[(pos_[vertex] + 1) % tour_.size()];
+}
+
+int LocalSearch::Prev(int vertex) const {
+  return tour_[(pos_[vertex] + tour_.size() - 1) % tour_.size()];
+}
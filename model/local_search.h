@@ -0,0 +1,47 @@
+#ifndef PARALLELS_ANT_MODEL_LOCAL_SEARCH_H_
+#define PARALLELS_ANT_MODEL_LOCAL_SEARCH_H_
+
+#include <deque>
+#include <vector>
+
+#include "graph.h"
+#include "heuristics.h"
+
+/**
+ * @brief Improves closed tours of a symmetric graph with 2-opt and Or-opt
+ * moves. Moves are searched only among the candidate lists of the graph, and
+ * don't-look bits keep vertices without improving moves out of the search
+ * until one of their tour neighbors changes.
+ *
+ * An object keeps scratch buffers between calls, so every thread should use
+ * its own instance.
+ */
+class LocalSearch {
+ public:
+  using Path = std::vector<int>;
+
+ public:
+  explicit LocalSearch(const Graph &graph);
+
+  bool Improve(int *path, size_t size, LocalSearchMethod method);
+
+ private:
+  bool TryTwoOpt(int a);
+  bool TryOrOpt(int a);
+  bool TryInsertion(int s1, int s2, size_t length, int x, long long gain);
+  void Reverse(size_t from, size_t length);
+  void Activate(int vertex);
+  bool HasEdge(int a, int b) const;
+  long long Weight(int a, int b) const;
+  int Next(int vertex) const;
+  int Prev(int vertex) const;
+
+ private:
+  const Graph &graph_;
+  Path tour_;
+  std::vector<size_t> pos_;
+  std::vector<bool> active_;
+  std::deque<int> queue_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_LOCAL_SEARCH_H_
@@ -0,0 +1,178 @@
+#include "lower_bound.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+/**
+ * @brief Constructs a LowerBound object for the given graph. The bound is
+ * zero until Run improves it.
+ *
+ * @param graph A reference to the graph whose tours are bounded.
+ */
+LowerBound::LowerBound(const Graph &graph)
+    : graph_{graph},
+      tree_weight_{0.0},
+      bound_{0.0},
+      upper_{std::numeric_limits<double>::infinity()},
+      cancel_{false} {}
+
+/**
+ * @brief Optimizes vertex penalties by subgradient ascent: every vertex of
+ * degree d in the minimum 1-tree gets its penalty raised by t * (d - 2), with
+ * the Polyak step t = step * (upper - weight) / |d - 2|^2. The step factor
+ * starts at 2 and is halved after kPatience iterations without a better
+ * bound. Every better bound is published at once, rounded up, since tour
+ * lengths are integers.
+ *
+ * Asymmetric graphs and graphs with fewer than three vertices are not
+ * bounded. The ascent stops early if it is cancelled, if the graph turns out
+ * to be disconnected, or if the 1-tree is a tour, which is then optimal.
+ *
+ * @param iterations The maximal number of 1-trees to build.
+ */
+void LowerBound::Run(size_t iterations) {
+  const size_t vertex_cnt = graph_.Size();
+  if (vertex_cnt < 3 or !graph_.IsSymmetric()) return;
+  penalties_.assign(vertex_cnt, 0.0);
+  double best = -std::numeric_limits<double>::infinity();
+  double step = 2.0;
+  size_t idle = 0;
+  for (size_t i = 0; i < iterations and !cancel_; ++i) {
+    if (!BuildOneTree()) return;
+    const double weight =
+        tree_weight_ -
+        2.0 * std::accumulate(penalties_.begin(), penalties_.end(), 0.0);
+    if (weight > best) {
+      best = weight;
+      idle = 0;
+      const double rounded = std::ceil(weight - 1e-9 * std::abs(weight));
+      if (rounded > bound_) bound_ = rounded;
+    } else if (++idle >= kPatience) {
+      step /= 2.0;
+      idle = 0;
+      if (step < kMinStep) return;
+    }
+
+    double norm = 0.0;
+    for (const int degree : degrees_) {
+      norm += (degree - 2) * (degree - 2);
+    }
+    const double upper = upper_;
+    if (norm == 0.0 or upper <= bound_) return;
+    const double target = std::isinf(upper) ? 1.05 * std::abs(weight) : upper;
+    const double t = step * std::max(target - weight, 0.0) / norm;
+    for (size_t v = 0; v < vertex_cnt; ++v) {
+      penalties_[v] += t * (degrees_[v] - 2);
+    }
+  }
+}
+
+/**
+ * @brief Asks Run to return after the current 1-tree.
+ *
+ */
+void LowerBound::Cancel() { cancel_ = true; }
+
+/**
+ * @brief Reports the length of a known tour, which guides step sizes and
+ * stops the ascent once the bound reaches it. Longer tours than the shortest
+ * one reported are ignored.
+ *
+ * @param upper The length of a tour.
+ */
+void LowerBound::SetUpperBound(double upper) {
+  double current = upper_;
+  while (upper < current and !upper_.compare_exchange_weak(current, upper)) {
+  }
+}
+
+/**
+ * @brief Returns the best lower bound found so far, 0 if there is none.
+ *
+ * @return double
+ */
+double LowerBound::Get() const { return bound_; }
+
+/**
+ * @brief Returns the relative gap (upper - bound) / bound between the
+ * shortest reported tour and the bound, or infinity if either is unknown.
+ *
+ * @return double
+ */
+double LowerBound::Gap() const {
+  const double bound = bound_;
+  const double upper = upper_;
+  if (bound <= 0.0 or std::isinf(upper)) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return (upper - bound) / bound;
+}
+
+/**
+ * @brief Builds a minimum 1-tree under the current penalties: a minimum
+ * spanning tree of all vertices but 0 by Prim's algorithm, plus the two
+ * cheapest edges of vertex 0. The weight of edge (i, j) is w(i, j) + pi(i) +
+ * pi(j). Missing edges are never used.
+ *
+ * @return False if the graph has no 1-tree.
+ */
+bool LowerBound::BuildOneTree() {
+  const size_t vertex_cnt = graph_.Size();
+  const double inf = std::numeric_limits<double>::infinity();
+  keys_.assign(vertex_cnt, inf);
+  parents_.assign(vertex_cnt, -1);
+  degrees_.assign(vertex_cnt, 0);
+  in_tree_.assign(vertex_cnt, false);
+  row_.resize(vertex_cnt);
+  tree_weight_ = 0.0;
+
+  const bool complete = graph_.HasCoordinates();
+  size_t current = 1;
+  in_tree_[current] = true;
+  for (size_t added = 2; added < vertex_cnt; ++added) {
+    graph_.GetWeightRow(current, row_.data());
+    const double penalty = penalties_[current];
+    int next = -1;
+    for (size_t v = 1; v < vertex_cnt; ++v) {
+      if (in_tree_[v]) continue;
+      if (row_[v] != 0 or complete) {
+        const double key = row_[v] + penalty + penalties_[v];
+        if (key < keys_[v]) {
+          keys_[v] = key;
+          parents_[v] = current;
+        }
+      }
+      if (keys_[v] < inf and (next == -1 or keys_[v] < keys_[next])) next = v;
+    }
+    if (next == -1) return false;
+    in_tree_[next] = true;
+    tree_weight_ += keys_[next];
+    ++degrees_[next];
+    ++degrees_[parents_[next]];
+    current = next;
+  }
+
+  graph_.GetWeightRow(0, row_.data());
+  int first = -1;
+  int second = -1;
+  const auto key = [this](int v) {
+    return row_[v] + penalties_[0] + penalties_[v];
+  };
+  for (size_t v = 1; v < vertex_cnt; ++v) {
+    if (row_[v] == 0 and !complete) continue;
+    if (first == -1 or key(v) < key(first)) {
+      second = first;
+      first = v;
+    } else if (second == -1 or key(v) < key(second)) {
+      second = v;
+    }
+  }
+  if (second == -1) return false;
+  tree_weight_ += key(first) + key(second);
+  degrees_[0] = 2;
+  ++degrees_[first];
+  ++degrees_[second];
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef PARALLELS_ANT_MODEL_LOWER_BOUND_H_
+#define PARALLELS_ANT_MODEL_LOWER_BOUND_H_
+
+#include <atomic>
+#include <vector>
+
+#include "graph.h"
+
+/**
+ * @brief Held-Karp lower bound on the length of a tour of a symmetric graph:
+ * the weight of a minimum 1-tree under vertex penalties, which are improved
+ * by subgradient optimization.
+ *
+ * Run can be executed on another pool thread while ants search for tours. The
+ * best bound so far, the upper bound used for step sizes and cancellation
+ * are atomic, so they can be read and set from other threads at any time.
+ */
+class LowerBound {
+ public:
+  explicit LowerBound(const Graph &graph);
+
+  void Run(size_t iterations);
+  void Cancel();
+  void SetUpperBound(double upper);
+  double Get() const;
+  double Gap() const;
+
+ private:
+  static constexpr size_t kPatience = 20;
+  static constexpr double kMinStep = 1e-4;
+
+  bool BuildOneTree();
+
+ private:
+  const Graph &graph_;
+  std::vector<double> penalties_;
+  std::vector<int> degrees_;
+  std::vector<double> keys_;
+  std::vector<int> parents_;
+  std::vector<bool> in_tree_;
+  std::vector<int> row_;
+  double tree_weight_;
+  std::atomic<double> bound_;
+  std::atomic<double> upper_;
+  std::atomic<bool> cancel_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_LOWER_BOUND_H_
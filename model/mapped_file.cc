@@ -0,0 +1,61 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+/**
+ * @brief Maps the whole file into memory.
+ *
+ * @param filename
+ * @throw std::logic_error "Open file error" if the file cannot be opened.
+ */
+MappedFile::MappedFile(const std::string &filename)
+    : data_{nullptr}, size_{0}, mapping_{nullptr} {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) throw std::logic_error("Open file error");
+  struct stat info;
+  if (::fstat(fd, &info) == 0 and S_ISREG(info.st_mode) and
+      info.st_size > 0) {
+    void *mapping =
+        ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      ::madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+      mapping_ = mapping;
+      data_ = static_cast<const char *>(mapping);
+      size_ = info.st_size;
+    }
+  }
+  ::close(fd);
+  if (mapping_) return;
+
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) throw std::logic_error("Open file error");
+  buffer_.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_) ::munmap(mapping_, size_);
+}
+
+/**
+ * @brief Returns the first byte of the file
+ *
+ * @return const char*
+ */
+const char *MappedFile::Data() const { return data_; }
+
+/**
+ * @brief Returns the size of the file in bytes
+ *
+ * @return size_t
+ */
+size_t MappedFile::Size() const { return size_; }
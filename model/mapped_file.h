@@ -0,0 +1,32 @@
+#ifndef PARALLELS_ANT_MODEL_MAPPED_FILE_H_
+#define PARALLELS_ANT_MODEL_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only view of a whole file. The file is memory-mapped, so large
+ * graphs are parsed straight from the page cache without copying; if the file
+ * cannot be mapped (e.g. a pipe), its contents are read into a buffer instead.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile(MappedFile &&other) = delete;
+  MappedFile &operator=(const MappedFile &other) = delete;
+  MappedFile &operator=(MappedFile &&other) = delete;
+
+  const char *Data() const;
+  size_t Size() const;
+
+ private:
+  const char *data_;
+  size_t size_;
+  void *mapping_;
+  std::string buffer_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_MAPPED_FILE_H_
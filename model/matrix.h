@@ -0,0 +1,186 @@
+#ifndef PARALLELS_ANT_MODEL_MATRIX_H_
+#define PARALLELS_ANT_MODEL_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Allocator returning memory aligned to the given boundary.
+ *
+ * @tparam T Element type.
+ * @tparam Alignment Alignment in bytes.
+ */
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+  void deallocate(T *p, size_t) {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
+
+/**
+ * @brief Dense row-major matrix stored in a single cache-line-aligned
+ * allocation. Every row starts on a cache line, so rows can be processed with
+ * aligned vector loads; the padding at the end of each row is filled with the
+ * same value as the matrix.
+ *
+ * A matrix can also be a read-only view of memory it does not own, such as a
+ * memory-mapped file, in which case it keeps the owner of that memory alive.
+ *
+ * @tparam T Element type.
+ */
+template <typename T>
+class Matrix {
+ public:
+  static constexpr size_t kAlignment = 64;
+  using Storage = std::vector<T, AlignedAllocator<T, kAlignment>>;
+
+ public:
+  Matrix() = default;
+
+  /**
+   * @brief Creates rows x cols matrix filled with value.
+   *
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   * @param value Initial value of every element.
+   */
+  Matrix(size_t rows, size_t cols, const T &value = T())
+      : rows_{rows},
+        cols_{cols},
+        stride_{PaddedStride(cols)},
+        storage_(rows * PaddedStride(cols), value),
+        data_{storage_.data()} {}
+
+  Matrix(const Matrix &other)
+      : rows_{other.rows_},
+        cols_{other.cols_},
+        stride_{other.stride_},
+        storage_{other.storage_},
+        data_{other.owner_ ? other.data_ : storage_.data()},
+        owner_{other.owner_} {}
+
+  Matrix(Matrix &&other) noexcept { Swap(other); }
+
+  Matrix &operator=(Matrix other) noexcept {
+    Swap(other);
+    return *this;
+  }
+
+  /**
+   * @brief Creates a read-only view of rows x cols elements laid out with the
+   * padded stride of this class. The view must not be modified.
+   *
+   * @param data The first element, aligned to kAlignment.
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   * @param owner Keeps the memory alive as long as the view or its copies.
+   */
+  static Matrix View(const T *data, size_t rows, size_t cols,
+                     std::shared_ptr<const void> owner) {
+    Matrix view;
+    view.rows_ = rows;
+    view.cols_ = cols;
+    view.stride_ = PaddedStride(cols);
+    view.data_ = const_cast<T *>(data);
+    view.owner_ = std::move(owner);
+    return view;
+  }
+
+  /**
+   * @brief Returns the row stride, in elements, of a matrix with cols
+   * columns.
+   */
+  static size_t PaddedStride(size_t cols) {
+    constexpr size_t per_line =
+        sizeof(T) < kAlignment ? kAlignment / sizeof(T) : 1;
+    return (cols + per_line - 1) / per_line * per_line;
+  }
+
+  size_t Rows() const { return rows_; }
+  size_t Cols() const { return cols_; }
+  size_t Stride() const { return stride_; }
+  bool Empty() const { return rows_ * cols_ == 0; }
+  bool IsView() const { return owner_ != nullptr; }
+
+  /**
+   * @brief Unchecked access to the element at (row, col).
+   */
+  T &operator()(size_t row, size_t col) { return data_[row * stride_ + col]; }
+  const T &operator()(size_t row, size_t col) const {
+    return data_[row * stride_ + col];
+  }
+
+  /**
+   * @brief Bounds-checked access to the element at (row, col).
+   *
+   * @throw std::out_of_range if the index is outside of the matrix.
+   */
+  const T &At(size_t row, size_t col) const {
+    if (row >= rows_ or col >= cols_) {
+      throw std::out_of_range("Matrix index out of range");
+    }
+    return (*this)(row, col);
+  }
+
+  T *Row(size_t row) { return data_ + row * stride_; }
+  const T *Row(size_t row) const { return data_ + row * stride_; }
+
+  T *Data() { return data_; }
+  const T *Data() const { return data_; }
+
+  /**
+   * @brief Assigns value to every element, keeping the shape.
+   *
+   * @param value
+   */
+  void Fill(const T &value) { std::fill_n(data_, rows_ * stride_, value); }
+
+ private:
+  void Swap(Matrix &other) noexcept {
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    std::swap(stride_, other.stride_);
+    storage_.swap(other.storage_);
+    std::swap(data_, other.data_);
+    owner_.swap(other.owner_);
+  }
+
+ private:
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t stride_ = 0;
+  Storage storage_;
+  T *data_ = nullptr;
+  std::shared_ptr<const void> owner_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_MATRIX_H_
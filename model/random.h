@@ -0,0 +1,86 @@
+#ifndef PARALLELS_ANT_MODEL_RANDOM_H_
+#define PARALLELS_ANT_MODEL_RANDOM_H_
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief xoshiro256** pseudo-random generator. It is small and fast enough to
+ * give every ant its own instance, so parallel ants never share state.
+ * Satisfies UniformRandomBitGenerator.
+ */
+class Random {
+ public:
+  using result_type = uint64_t;
+
+ public:
+  /**
+   * @brief Seeds the generator state through SplitMix64, as recommended by
+   * the xoshiro authors.
+   *
+   * @param seed Any 64-bit value.
+   */
+  explicit Random(uint64_t seed = 0) {
+    for (auto &word : state_) {
+      word = SplitMix(seed);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * @brief Returns next 64 random bits.
+   *
+   * @return result_type
+   */
+  result_type operator()() {
+    const uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = Rotl(state_[3], 45);
+    return result;
+  }
+
+  /**
+   * @brief Returns a uniformly distributed double in [0, 1).
+   *
+   * @return double
+   */
+  double NextDouble() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+  /**
+   * @brief Derives an independent seed for a numbered stream, e.g. for the
+   * ant starting at a given vertex.
+   *
+   * @param seed Parent seed.
+   * @param stream Number of the stream.
+   * @return uint64_t
+   */
+  static uint64_t Derive(uint64_t seed, uint64_t stream) {
+    uint64_t state = seed ^ (stream * 0x9e3779b97f4a7c15ULL);
+    SplitMix(state);
+    return SplitMix(state);
+  }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  static uint64_t SplitMix(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  uint64_t state_[4];
+};
+
+#endif  // PARALLELS_ANT_MODEL_RANDOM_H_
@@ -0,0 +1,94 @@
+#ifndef PARALLELS_ANT_MODEL_STATS_H_
+#define PARALLELS_ANT_MODEL_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#ifdef ANT_STATS
+#define ANT_STATS_ONLY(...) __VA_ARGS__
+#define ANT_TIMED(total, ...) \
+  do {                        \
+    PhaseTimer timer(total);  \
+    __VA_ARGS__;              \
+  } while (0)
+#else
+#define ANT_STATS_ONLY(...)
+#define ANT_TIMED(total, ...) __VA_ARGS__
+#endif
+
+/**
+ * @brief Timings and counters of one run of the algorithm. They are collected
+ * only if the model is built with ANT_STATS defined (the ANT_STATS CMake
+ * option); otherwise the instrumentation is compiled out and every value
+ * stays zero.
+ *
+ * Times are in seconds. Phase times are summed over colonies, so they exceed
+ * the total time when colonies run in parallel. Busy and idle times are
+ * reported per pool thread, the calling thread first. They count every loop
+ * run on the pool during the run, so they are only meaningful on a pool that
+ * is not shared with concurrent runs.
+ */
+struct AlgorithmStats {
+#ifdef ANT_STATS
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  double total_time = 0.0;
+  double construction_time = 0.0;
+  double improvement_time = 0.0;
+  double result_time = 0.0;
+  double pheromone_time = 0.0;
+  double choice_info_time = 0.0;
+  double check_time = 0.0;
+  uint64_t colonies = 0;
+  uint64_t bypasses = 0;
+  uint64_t steps = 0;
+  uint64_t dead_ends = 0;
+  uint64_t improvements = 0;
+  std::vector<double> thread_busy;
+  std::vector<double> thread_idle;
+
+  /**
+   * @brief Adds the phase times and counters of a colony.
+   *
+   * @param other
+   */
+  void Merge(const AlgorithmStats &other) {
+    construction_time += other.construction_time;
+    improvement_time += other.improvement_time;
+    result_time += other.result_time;
+    pheromone_time += other.pheromone_time;
+    choice_info_time += other.choice_info_time;
+    colonies += other.colonies;
+    bypasses += other.bypasses;
+    steps += other.steps;
+    dead_ends += other.dead_ends;
+    improvements += other.improvements;
+  }
+};
+
+/**
+ * @brief Adds the time between its construction and destruction to a
+ * counter of seconds.
+ */
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(double &total) : total_{total}, start_{Clock::now()} {}
+  ~PhaseTimer() {
+    total_ += std::chrono::duration<double>(Clock::now() - start_).count();
+  }
+
+  PhaseTimer(const PhaseTimer &other) = delete;
+  PhaseTimer &operator=(const PhaseTimer &other) = delete;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  double &total_;
+  Clock::time_point start_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_STATS_H_
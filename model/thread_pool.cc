@@ -0,0 +1,237 @@
+#include "thread_pool.h"
+
+namespace {
+
+/**
+ * @brief The pool a thread works for and its slot there, 0 being the caller
+ * of ParallelFor.
+ */
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_slot = 0;
+#ifdef ANT_STATS
+thread_local size_t chunk_depth = 0;
+#endif
+
+}  // namespace
+
+/**
+ * @brief Shared state of one ParallelFor call. Chunks are pulled through an
+ * atomic counter, so fast threads simply take more of them.
+ */
+struct ThreadPool::Job {
+  const Body *body;
+  size_t count;
+  size_t grain;
+  size_t chunks;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::exception_ptr error;
+  std::mutex mtx;
+  std::condition_variable cv;
+};
+
+/**
+ * @brief Starts threads - 1 background workers, the caller of ParallelFor
+ * being the last one.
+ *
+ * @param threads Total number of threads taking part in parallel loops.
+ */
+ThreadPool::ThreadPool(size_t threads) : running_{0}, stop_{false} {
+  const size_t workers = threads > 1 ? threads - 1 : 0;
+  busy_ = std::make_unique<std::atomic<uint64_t>[]>(workers + 1);
+  ResetStats();
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i + 1);
+  }
+}
+
+/**
+ * @brief Stops and joins all workers.
+ *
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Returns number of threads taking part in parallel loops.
+ *
+ * @return Number of workers plus the calling thread.
+ */
+size_t ThreadPool::Size() const { return workers_.size() + 1; }
+
+/**
+ * @brief Calls body(begin, end) for consecutive chunks covering [0, count)
+ * and returns when all of them are processed. The first exception thrown by
+ * body is rethrown in the calling thread.
+ *
+ * @param count Number of items.
+ * @param body Function processing items in range [begin, end).
+ * @param grain Items per chunk, 0 to choose automatically.
+ */
+void ThreadPool::ParallelFor(size_t count, const Body &body, size_t grain) {
+  if (count == 0) return;
+  if (grain == 0) {
+    const size_t chunks = Size() * 4;
+    grain = (count + chunks - 1) / chunks;
+  }
+  auto job = std::make_shared<Job>();
+  job->body = &body;
+  job->count = count;
+  job->grain = grain;
+  job->chunks = (count + grain - 1) / grain;
+
+  EnqueueHelpers(job);
+  RunChunks(*job);
+
+  while (job->done.load() != job->chunks) {
+    if (RunPendingTask()) continue;
+    std::unique_lock<std::mutex> lock(job->mtx);
+    job->cv.wait(lock, [&job] { return job->done.load() == job->chunks; });
+  }
+  if (job->error) std::rethrow_exception(job->error);
+}
+
+/**
+ * @brief Returns the seconds each thread has spent in loop bodies since the
+ * last ResetStats, the calling thread first. All zeros without ANT_STATS.
+ * Users of a shared pool should take the difference of two readings
+ * instead of resetting.
+ *
+ * @return std::vector<double>
+ */
+std::vector<double> ThreadPool::GetBusyTimes() const {
+  std::vector<double> times(Size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    times[i] = busy_[i].load() * 1e-9;
+  }
+  return times;
+}
+
+/**
+ * @brief Zeroes the busy times. Must not be called during a parallel loop,
+ * nor on a pool shared with other users, whose readings it would break.
+ *
+ */
+void ThreadPool::ResetStats() {
+  for (size_t i = 0; i < Size(); ++i) {
+    busy_[i] = 0;
+  }
+}
+
+/**
+ * @brief Processes chunks of the job until none are left. With ANT_STATS,
+ * the time is added to the busy time of the thread unless the job is nested
+ * in a chunk the thread is already running.
+ *
+ * @param job Shared state of a ParallelFor call.
+ */
+void ThreadPool::RunChunks(Job &job) {
+#ifdef ANT_STATS
+  const size_t slot = CurrentSlot();
+  ++chunk_depth;
+  const auto start = std::chrono::steady_clock::now();
+#endif
+  for (size_t chunk = job.next++; chunk < job.chunks; chunk = job.next++) {
+    const size_t begin = chunk * job.grain;
+    const size_t end = std::min(begin + job.grain, job.count);
+    try {
+      (*job.body)(begin, end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(job.mtx);
+      if (!job.error) job.error = std::current_exception();
+    }
+    if (++job.done == job.chunks) {
+      std::lock_guard<std::mutex> lock(job.mtx);
+      job.cv.notify_all();
+    }
+  }
+#ifdef ANT_STATS
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  if (--chunk_depth == 0) {
+    busy_[slot] += std::chrono::nanoseconds(elapsed).count();
+  }
+#endif
+}
+
+/**
+ * @brief Returns the slot of the calling thread in the pool, 0 for threads
+ * that are not its workers.
+ *
+ * @return size_t
+ */
+size_t ThreadPool::CurrentSlot() const {
+  return current_pool == this ? current_slot : 0;
+}
+
+/**
+ * @brief Executes one queued task in the calling thread, if there is any.
+ *
+ * @return True if a task has been executed.
+ */
+bool ThreadPool::RunPendingTask() {
+  Task task;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (tasks_.empty()) return false;
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+  task();
+  return true;
+}
+
+/**
+ * @brief Queues one helper task per idle worker, at most one per chunk after
+ * the first, and wakes the workers up. Workers running tasks or about to take
+ * queued ones are not idle.
+ *
+ * @param job Shared state of a ParallelFor call.
+ */
+void ThreadPool::EnqueueHelpers(const std::shared_ptr<Job> &job) {
+  size_t helpers = 0;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const size_t busy = running_ + tasks_.size();
+    const size_t idle = workers_.size() > busy ? workers_.size() - busy : 0;
+    helpers = std::min(idle, job->chunks - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+      tasks_.push_back([this, job] { RunChunks(*job); });
+    }
+  }
+  for (size_t i = 0; i < helpers; ++i) {
+    cv_.notify_one();
+  }
+}
+
+/**
+ * @brief Main loop of a background worker.
+ *
+ * @param slot Index of the worker among the pool threads, starting from 1.
+ */
+void ThreadPool::WorkerLoop(size_t slot) {
+  current_pool = this;
+  current_slot = slot;
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ or !tasks_.empty(); });
+      if (stop_ and tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      ++running_;
+    }
+    task();
+    std::lock_guard<std::mutex> lock(mtx_);
+    --running_;
+  }
+}
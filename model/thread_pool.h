@@ -0,0 +1,69 @@
+#ifndef PARALLELS_ANT_MODEL_THREAD_POOL_H_
+#define PARALLELS_ANT_MODEL_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stats.h"
+
+/**
+ * @brief Fixed-size pool of long-lived worker threads.
+ *
+ * The calling thread always takes part in ParallelFor, so a pool of size N
+ * keeps N - 1 background workers. Waiting callers execute queued work instead
+ * of blocking, which makes nested ParallelFor calls safe. Helper tasks are
+ * queued only for idle workers, so a nested loop whose workers are all busy
+ * is run by its caller alone instead of leaving tasks nobody takes.
+ *
+ * With ANT_STATS defined, the pool also sums the time each thread spends in
+ * loop bodies. Nested loops are counted once, as part of their outer chunk,
+ * so a thread is never busy for longer than the wall time.
+ */
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+  using Body = std::function<void(size_t, size_t)>;
+
+ public:
+  explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &other) = delete;
+  ThreadPool(ThreadPool &&other) = delete;
+  ThreadPool &operator=(const ThreadPool &other) = delete;
+  ThreadPool &operator=(ThreadPool &&other) = delete;
+
+  size_t Size() const;
+  void ParallelFor(size_t count, const Body &body, size_t grain = 0);
+  std::vector<double> GetBusyTimes() const;
+  void ResetStats();
+
+ private:
+  struct Job;
+
+  void WorkerLoop(size_t slot);
+  bool RunPendingTask();
+  void EnqueueHelpers(const std::shared_ptr<Job> &job);
+  void RunChunks(Job &job);
+  size_t CurrentSlot() const;
+
+ private:
+  std::vector<std::thread> workers_;
+  std::unique_ptr<std::atomic<uint64_t>[]> busy_;
+  std::deque<Task> tasks_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  size_t running_;
+  bool stop_;
+};
+
+#endif  // PARALLELS_ANT_MODEL_THREAD_POOL_H_
@@ -0,0 +1,98 @@
+#include <sys/resource.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../model/random.h"
+#include "../view/batch.h"
+
+namespace {
+
+constexpr size_t kGraphSize = 30;
+constexpr size_t kSmallBatch = 24;
+constexpr size_t kLargeBatch = 96;
+constexpr long kMaxGrowthKb = 8 * 1024;
+
+/**
+ * @brief Returns the peak resident set size of the process in kilobytes.
+ */
+long PeakMemoryKb() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+/**
+ * @brief Writes a complete symmetric graph with weights uniform in
+ * [1, 1000] as an adjacency matrix.
+ */
+void WriteGraph(const std::filesystem::path &path) {
+  Random random(1);
+  std::vector<int> weights(kGraphSize * kGraphSize, 0);
+  for (size_t i = 0; i < kGraphSize; ++i) {
+    for (size_t j = i + 1; j < kGraphSize; ++j) {
+      weights[i * kGraphSize + j] = weights[j * kGraphSize + i] =
+          1 + random() % 1000;
+    }
+  }
+  std::ofstream out(path);
+  out << kGraphSize << '\n';
+  for (size_t i = 0; i < kGraphSize; ++i) {
+    for (size_t j = 0; j < kGraphSize; ++j) {
+      out << weights[i * kGraphSize + j] << (j + 1 < kGraphSize ? ' ' : '\n');
+    }
+  }
+}
+
+/**
+ * @brief Solves the same graph count times in one batch with nested
+ * parallelism.
+ */
+int RunBatch(const std::string &graph, const std::string &output,
+             size_t count) {
+  std::vector<std::string> args = {"Ant", "--threads", "4", "--mode", "ants"};
+  args.insert(args.end(), {"--set", "colonies=25", "--seed", "1"});
+  args.insert(args.end(), {"--output", output});
+  args.insert(args.end(), count, graph);
+  std::vector<char *> argv;
+  for (auto &arg : args) {
+    argv.push_back(arg.data());
+  }
+  return Batch::Main(static_cast<int>(argv.size()), argv.data());
+}
+
+}  // namespace
+
+/**
+ * @brief Checks that the peak memory of a batch with nested parallel loops
+ * does not grow with the number of graphs.
+ */
+int main() {
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::string graph = (dir / "ant_batch_check_graph.txt").string();
+  const std::string output = (dir / "ant_batch_check_output.txt").string();
+  WriteGraph(graph);
+
+  int status = RunBatch(graph, output, kSmallBatch);
+  const long small = PeakMemoryKb();
+  if (status == 0) status = RunBatch(graph, output, kLargeBatch);
+  const long large = PeakMemoryKb();
+  std::filesystem::remove(graph);
+  std::filesystem::remove(output);
+  if (status != 0) {
+    std::cerr << "batch failed with status " << status << '\n';
+    return 1;
+  }
+
+  std::cout << "peak memory: " << small << " KB after " << kSmallBatch
+            << " graphs, " << large << " KB after " << kLargeBatch
+            << " graphs\n";
+  if (large - small > kMaxGrowthKb) {
+    std::cerr << "peak memory grows with the number of graphs\n";
+    return 1;
+  }
+  return 0;
+}
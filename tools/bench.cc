@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../model/ant_algorithm.h"
+#include "../model/graph.h"
+#include "../model/heuristics.h"
+#include "../model/lower_bound.h"
+#include "../model/random.h"
+#include "../model/stats.h"
+#include "../model/thread_pool.h"
+
+namespace {
+
+struct Options {
+  std::vector<std::string> kinds{"random", "euclidean", "sparse"};
+  std::vector<size_t> sizes{50, 100, 200};
+  std::vector<size_t> threads{
+      1, std::max<size_t>(2, std::thread::hardware_concurrency())};
+  std::vector<std::string> modes{"serial", "ants", "colonies", "islands"};
+  std::vector<std::string> updates{"classic"};
+  std::vector<std::string> local_searches{"none"};
+  std::vector<std::string> settings;
+  size_t repeats = 5;
+  size_t colonies = 4;
+  size_t bypasses = 10;
+  size_t bound_iterations = 200;
+  uint64_t seed = 1;
+  std::string format = "json";
+  std::string output;
+};
+
+struct Record {
+  std::string kind;
+  size_t size;
+  std::string mode;
+  std::string update;
+  std::string local_search;
+  size_t threads;
+  size_t runs;
+  size_t solved;
+  double median_time;
+  double p95_time;
+  double min_time;
+  double bypasses_per_second;
+  double best_length;
+  double median_length;
+  double lower_bound;
+  AlgorithmStats stats;
+};
+
+void PrintUsage() {
+  std::cerr
+      << "Usage: ant_bench [options]\n"
+         "Runs the ant algorithm on generated graphs and reports timings and "
+         "tour quality.\n"
+         "  --kinds LIST       random, euclidean, sparse\n"
+         "  --sizes LIST       numbers of vertices (50,100,200)\n"
+         "  --threads LIST     pool sizes for the parallel modes\n"
+         "  --modes LIST       serial, ants, colonies, islands\n"
+         "  --updates LIST     classic, mmas, acs\n"
+         "  --local-search LIST\n"
+         "                     none, 2opt, oropt, both (none)\n"
+         "  --repeats N        runs per configuration (5)\n"
+         "  --colonies N       colonies per run (4)\n"
+         "  --bypasses N       bypasses per colony (10)\n"
+         "  --bound N          Held-Karp iterations for quality, 0 to skip "
+         "(200)\n"
+         "  --set KEY=VALUE    any other algorithm parameter, repeatable\n"
+         "  --seed N           seed of graphs and runs (1)\n"
+         "  --format FORMAT    json or csv (json)\n"
+         "  --output FILE      write the report to FILE instead of stdout\n";
+}
+
+std::vector<std::string> SplitList(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  if (items.empty()) throw std::invalid_argument("Empty list: " + list);
+  return items;
+}
+
+std::vector<size_t> SplitNumbers(const std::string &list) {
+  std::vector<size_t> numbers;
+  for (const auto &item : SplitList(list)) {
+    numbers.push_back(std::stoul(item));
+  }
+  return numbers;
+}
+
+Options ParseOptions(int argc, char *argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + key);
+    const std::string value = argv[++i];
+    if (key == "--kinds") {
+      options.kinds = SplitList(value);
+    } else if (key == "--sizes") {
+      options.sizes = SplitNumbers(value);
+    } else if (key == "--threads") {
+      options.threads = SplitNumbers(value);
+    } else if (key == "--modes") {
+      options.modes = SplitList(value);
+    } else if (key == "--updates") {
+      options.updates = SplitList(value);
+    } else if (key == "--local-search") {
+      options.local_searches = SplitList(value);
+    } else if (key == "--repeats") {
+      options.repeats = std::stoul(value);
+    } else if (key == "--colonies") {
+      options.colonies = std::stoul(value);
+    } else if (key == "--bypasses") {
+      options.bypasses = std::stoul(value);
+    } else if (key == "--bound") {
+      options.bound_iterations = std::stoul(value);
+    } else if (key == "--set") {
+      options.settings.push_back(value);
+    } else if (key == "--seed") {
+      options.seed = std::stoull(value);
+    } else if (key == "--format") {
+      options.format = value;
+    } else if (key == "--output") {
+      options.output = value;
+    } else {
+      throw std::invalid_argument("Unknown option " + key);
+    }
+  }
+  if (options.format != "json" and options.format != "csv") {
+    throw std::invalid_argument("Unknown format " + options.format);
+  }
+  if (options.repeats == 0) throw std::invalid_argument("No repeats");
+  return options;
+}
+
+Parallelism ParseMode(const std::string &mode) {
+  if (mode == "serial") return Parallelism::kNone;
+  if (mode == "ants") return Parallelism::kAnts;
+  if (mode == "colonies") return Parallelism::kColonies;
+  if (mode == "islands") return Parallelism::kIslands;
+  throw std::invalid_argument("Unknown mode " + mode);
+}
+
+/**
+ * @brief Writes a complete symmetric graph with weights uniform in
+ * [1, 1000] as an adjacency matrix.
+ */
+void WriteRandomGraph(std::ostream &out, size_t size, Random &random) {
+  std::vector<int> weights(size * size, 0);
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = i + 1; j < size; ++j) {
+      weights[i * size + j] = weights[j * size + i] = 1 + random() % 1000;
+    }
+  }
+  out << size << '\n';
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      out << weights[i * size + j] << (j + 1 < size ? ' ' : '\n');
+    }
+  }
+}
+
+/**
+ * @brief Writes a TSPLIB EUC_2D instance with points uniform in a square.
+ */
+void WriteEuclideanGraph(std::ostream &out, size_t size, Random &random) {
+  out << "NAME : bench" << size << "\nTYPE : TSP\nDIMENSION : " << size
+      << "\nEDGE_WEIGHT_TYPE : EUC_2D\nNODE_COORD_SECTION\n";
+  for (size_t i = 0; i < size; ++i) {
+    out << i + 1 << ' ' << random.NextDouble() * 10000.0 << ' '
+        << random.NextDouble() * 10000.0 << '\n';
+  }
+  out << "EOF\n";
+}
+
+/**
+ * @brief Writes a symmetric graph with about 5% of the vertex pairs
+ * connected, so that it is stored sparse. A random Hamiltonian cycle is
+ * always included, so the graph has a tour.
+ */
+void WriteSparseGraph(std::ostream &out, size_t size, Random &random) {
+  std::vector<int> weights(size * size, 0);
+  std::vector<size_t> order(size);
+  for (size_t i = 0; i < size; ++i) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), random);
+  const auto connect = [&](size_t i, size_t j) {
+    weights[i * size + j] = weights[j * size + i] = 1 + random() % 1000;
+  };
+  for (size_t k = 0; k < size; ++k) {
+    connect(order[k], order[(k + 1) % size]);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = i + 1; j < size; ++j) {
+      if (!weights[i * size + j] and random.NextDouble() < 0.04) {
+        connect(i, j);
+      }
+    }
+  }
+  out << size << '\n';
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      out << weights[i * size + j] << (j + 1 < size ? ' ' : '\n');
+    }
+  }
+}
+
+/**
+ * @brief Generates a graph through a temporary file, so that it goes through
+ * the same loader as user graphs.
+ */
+void GenerateGraph(Graph &graph, const std::string &kind, size_t size,
+                   uint64_t seed) {
+  Random random(Random::Derive(seed, size));
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("ant_bench_" + kind + "_" + std::to_string(size) + "_" +
+                     std::to_string(seed) + ".txt");
+  {
+    std::ofstream out(path);
+    if (kind == "random") {
+      WriteRandomGraph(out, size, random);
+    } else if (kind == "euclidean") {
+      WriteEuclideanGraph(out, size, random);
+    } else if (kind == "sparse") {
+      WriteSparseGraph(out, size, random);
+    } else {
+      throw std::invalid_argument("Unknown graph kind " + kind);
+    }
+    if (!out) throw std::runtime_error("Cannot write " + path.string());
+  }
+  try {
+    graph.LoadGraphFromFile(path.string());
+  } catch (...) {
+    std::filesystem::remove(path);
+    throw;
+  }
+  std::filesystem::remove(path);
+}
+
+/**
+ * @brief Returns the value at the nearest rank of the given fraction of
+ * sorted values.
+ */
+double Percentile(std::vector<double> values, double fraction) {
+  std::sort(values.begin(), values.end());
+  const size_t rank =
+      static_cast<size_t>(std::ceil(fraction * values.size()));
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
+/**
+ * @brief Applies the --set parameters on top of the given ones.
+ */
+void ApplySettings(const Options &options, Heuristics &heuristics) {
+  for (const auto &setting : options.settings) {
+    const size_t eq = setting.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("Setting without '=': " + setting);
+    }
+    heuristics.Set(setting.substr(0, eq), setting.substr(eq + 1));
+  }
+}
+
+Record Measure(const Graph &graph, const Options &options,
+               const std::string &mode, const std::string &update,
+               const std::string &local_search, size_t threads) {
+  Heuristics heuristics;
+  heuristics.colonies = options.colonies;
+  heuristics.bypass_count = options.bypasses;
+  heuristics.exact_size = 0;
+  heuristics.Set("update", update);
+  heuristics.Set("local_search", local_search);
+  ApplySettings(options, heuristics);
+
+  AntAlgorithm algorithm(graph, std::make_shared<ThreadPool>(threads));
+  algorithm.SetHeuristics(heuristics);
+  algorithm.SetParallelism(ParseMode(mode));
+
+  Record record{};
+  record.mode = mode;
+  record.update = update;
+  record.local_search = local_search;
+  record.threads = threads;
+  record.runs = options.repeats;
+  std::vector<double> times;
+  std::vector<double> lengths;
+  size_t bypasses = 0;
+  for (size_t run = 0; run < options.repeats; ++run) {
+    algorithm.SetSeed(options.seed + run);
+    const auto start = std::chrono::steady_clock::now();
+    algorithm.RunAlgorithm();
+    const auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double>(end - start).count());
+    bypasses += algorithm.GetBypassCount();
+    try {
+      lengths.push_back(algorithm.GetResult().distance);
+    } catch (const std::logic_error &) {
+    }
+    record.stats = algorithm.GetStats();
+  }
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  record.solved = lengths.size();
+  record.median_time = Percentile(times, 0.5);
+  record.p95_time = Percentile(times, 0.95);
+  record.min_time = *std::min_element(times.begin(), times.end());
+  record.bypasses_per_second =
+      bypasses / std::accumulate(times.begin(), times.end(), 0.0);
+  record.best_length =
+      lengths.empty() ? nan : *std::min_element(lengths.begin(), lengths.end());
+  record.median_length = lengths.empty() ? nan : Percentile(lengths, 0.5);
+  return record;
+}
+
+std::string Number(double value) {
+  if (std::isnan(value)) return "null";
+  std::ostringstream out;
+  out.precision(6);
+  out << value;
+  return out.str();
+}
+
+/**
+ * @brief Returns the phase timings and counters of the last run of a record
+ * as pairs of a name and a value, or nothing if the model is built without
+ * ANT_STATS.
+ */
+std::vector<std::pair<std::string, double>> StatsFields(const Record &r) {
+  if (!AlgorithmStats::kEnabled) return {};
+  const AlgorithmStats &st = r.stats;
+  const auto sum = [](const std::vector<double> &values) {
+    return std::accumulate(values.begin(), values.end(), 0.0);
+  };
+  return {{"total_time", st.total_time},
+          {"construction_time", st.construction_time},
+          {"improvement_time", st.improvement_time},
+          {"result_time", st.result_time},
+          {"pheromone_time", st.pheromone_time},
+          {"choice_info_time", st.choice_info_time},
+          {"check_time", st.check_time},
+          {"steps", static_cast<double>(st.steps)},
+          {"dead_ends", static_cast<double>(st.dead_ends)},
+          {"improvements", static_cast<double>(st.improvements)},
+          {"busy_time", sum(st.thread_busy)},
+          {"idle_time", sum(st.thread_idle)}};
+}
+
+void WriteJson(std::ostream &out, const std::vector<Record> &records) {
+  out << "[\n";
+  for (size_t i = 0; i < records.size(); ++i) {
+    const Record &r = records[i];
+    out << "  {\"kind\": \"" << r.kind << "\", \"size\": " << r.size
+        << ", \"mode\": \"" << r.mode << "\", \"update\": \"" << r.update
+        << "\", \"local_search\": \"" << r.local_search
+        << "\", \"threads\": " << r.threads << ", \"runs\": " << r.runs
+        << ", \"solved\": " << r.solved
+        << ", \"median_time\": " << Number(r.median_time)
+        << ", \"p95_time\": " << Number(r.p95_time)
+        << ", \"min_time\": " << Number(r.min_time)
+        << ", \"bypasses_per_second\": " << Number(r.bypasses_per_second)
+        << ", \"best_length\": " << Number(r.best_length)
+        << ", \"median_length\": " << Number(r.median_length)
+        << ", \"lower_bound\": " << Number(r.lower_bound);
+    for (const auto &[name, value] : StatsFields(r)) {
+      out << ", \"" << name << "\": " << Number(value);
+    }
+    out << "}" << (i + 1 < records.size() ? "," : "") << '\n';
+  }
+  out << "]\n";
+}
+
+void WriteCsv(std::ostream &out, const std::vector<Record> &records) {
+  out << "kind,size,mode,update,local_search,threads,runs,solved,"
+         "median_time,p95_time,min_time,bypasses_per_second,best_length,"
+         "median_length,lower_bound";
+  for (const auto &field : StatsFields(Record{})) {
+    out << ',' << field.first;
+  }
+  out << '\n';
+  for (const Record &r : records) {
+    const auto field = [](double value) {
+      return std::isnan(value) ? std::string() : Number(value);
+    };
+    out << r.kind << ',' << r.size << ',' << r.mode << ',' << r.update << ','
+        << r.local_search << ',' << r.threads << ',' << r.runs << ','
+        << r.solved << ','
+        << field(r.median_time) << ',' << field(r.p95_time) << ','
+        << field(r.min_time) << ',' << field(r.bypasses_per_second) << ','
+        << field(r.best_length) << ',' << field(r.median_length) << ','
+        << field(r.lower_bound);
+    for (const auto &stat : StatsFields(r)) {
+      out << ',' << field(stat.second);
+    }
+    out << '\n';
+  }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc == 2 and std::string(argv[1]) == "--help") {
+    PrintUsage();
+    return 0;
+  }
+  Options options;
+  try {
+    options = ParseOptions(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    PrintUsage();
+    return 2;
+  }
+
+  try {
+    std::vector<Record> records;
+    for (const auto &kind : options.kinds) {
+      for (const size_t size : options.sizes) {
+        Graph graph;
+        GenerateGraph(graph, kind, size, options.seed);
+        Heuristics settings;
+        ApplySettings(options, settings);
+        graph.ExtendCandidateLists(settings.candidates);
+        double lower_bound = std::numeric_limits<double>::quiet_NaN();
+        if (options.bound_iterations) {
+          LowerBound bound(graph);
+          bound.Run(options.bound_iterations);
+          if (bound.Get() > 0.0) lower_bound = bound.Get();
+        }
+        for (const auto &update : options.updates) {
+          for (const auto &local_search : options.local_searches) {
+            for (const auto &mode : options.modes) {
+              for (const size_t threads : options.threads) {
+                if (mode == "serial" and threads != options.threads.front()) {
+                  continue;
+                }
+                Record record =
+                    Measure(graph, options, mode, update, local_search,
+                            mode == "serial" ? 1 : threads);
+                record.kind = kind;
+                record.size = size;
+                record.lower_bound = lower_bound;
+                std::cerr << kind << ' ' << size << ' ' << update << ' '
+                          << local_search << ' ' << mode << ' '
+                          << record.threads << ": " << record.median_time
+                          << " s\n";
+                records.push_back(std::move(record));
+              }
+            }
+          }
+        }
+      }
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+      file.open(options.output);
+      if (!file) throw std::runtime_error("Cannot write " + options.output);
+    }
+    std::ostream &out = options.output.empty() ? std::cout : file;
+    options.format == "json" ? WriteJson(out, records)
+                             : WriteCsv(out, records);
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "../model/binary_graph.h"
+#include "../model/graph.h"
+#include "../model/mapped_file.h"
+#include "../model/thread_pool.h"
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: ant_convert <input> <output>\n"
+               "       ant_convert --check <file>\n"
+               "Converts an adjacency matrix to the binary graph format, or "
+               "checks the\nchecksum of a binary graph.\n";
+}
+
+/**
+ * @brief Verifies the checksum of a binary graph file
+ *
+ * @param filename
+ * @return bool
+ */
+bool CheckBinary(const std::string &filename) {
+  const MappedFile file(filename);
+  if (!IsBinaryGraph(file.Data(), file.Size())) {
+    std::cerr << filename << ": not a binary graph\n";
+    return false;
+  }
+  BinaryGraphHeader header;
+  std::copy_n(file.Data(), sizeof(header), reinterpret_cast<char *>(&header));
+  const uint64_t checksum = BinaryGraphChecksum(
+      file.Data() + sizeof(header), file.Size() - sizeof(header));
+  if (checksum != header.checksum) {
+    std::cerr << filename << ": checksum mismatch\n";
+    return false;
+  }
+  std::cout << filename << ": " << header.size << " vertices, checksum ok\n";
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    PrintUsage();
+    return 2;
+  }
+  try {
+    const std::string first = argv[1];
+    if (first == "--check") return CheckBinary(argv[2]) ? 0 : 1;
+
+    ThreadPool pool;
+    Graph graph;
+    graph.LoadGraphFromFile(first, &pool);
+    graph.SaveGraphToBinary(argv[2]);
+    return CheckBinary(argv[2]) ? 0 : 1;
+  } catch (std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+}
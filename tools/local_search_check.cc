@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "../model/ant_algorithm.h"
+#include "../model/graph.h"
+#include "../model/heuristics.h"
+#include "../model/local_search.h"
+#include "../model/random.h"
+
+namespace {
+
+constexpr size_t kGraphSize = 60;
+constexpr size_t kTours = 20;
+const char *const kMethods[] = {"2opt", "oropt", "both"};
+
+/**
+ * @brief Writes a complete symmetric graph with weights uniform in
+ * [1, 1000] as an adjacency matrix.
+ */
+void WriteMatrixGraph(const std::string &path, Random &random) {
+  std::vector<int> weights(kGraphSize * kGraphSize, 0);
+  for (size_t i = 0; i < kGraphSize; ++i) {
+    for (size_t j = i + 1; j < kGraphSize; ++j) {
+      weights[i * kGraphSize + j] = weights[j * kGraphSize + i] =
+          1 + random() % 1000;
+    }
+  }
+  std::ofstream out(path);
+  out << kGraphSize << '\n';
+  for (size_t i = 0; i < kGraphSize; ++i) {
+    for (size_t j = 0; j < kGraphSize; ++j) {
+      out << weights[i * kGraphSize + j] << (j + 1 < kGraphSize ? ' ' : '\n');
+    }
+  }
+}
+
+/**
+ * @brief Writes a TSPLIB EUC_2D instance with points uniform in a square.
+ */
+void WriteCoordinateGraph(const std::string &path, Random &random) {
+  std::ofstream out(path);
+  out << "DIMENSION : " << kGraphSize
+      << "\nEDGE_WEIGHT_TYPE : EUC_2D\nNODE_COORD_SECTION\n";
+  for (size_t i = 0; i < kGraphSize; ++i) {
+    out << i + 1 << ' ' << random.NextDouble() * 1000.0 << ' '
+        << random.NextDouble() * 1000.0 << '\n';
+  }
+  out << "EOF\n";
+}
+
+/**
+ * @brief Returns the length of a path, or -1 if it is not a closed tour
+ * through every vertex exactly once.
+ */
+long long TourLength(const Graph &graph, const int *path, size_t size) {
+  const size_t vertex_cnt = graph.Size();
+  if (size != vertex_cnt + 1 or path[0] != path[vertex_cnt]) return -1;
+  std::vector<bool> seen(vertex_cnt);
+  long long length = 0;
+  for (size_t i = 0; i < vertex_cnt; ++i) {
+    if (path[i] < 0 or static_cast<size_t>(path[i]) >= vertex_cnt or
+        seen[path[i]]) {
+      return -1;
+    }
+    seen[path[i]] = true;
+    length += graph.GetWeight(path[i], path[i + 1]);
+  }
+  return length;
+}
+
+/**
+ * @brief Improves random tours with every method and checks that each one
+ * stays a tour with the same start and gets no longer.
+ */
+bool CheckRandomTours(const Graph &graph, const std::string &name,
+                      Random &random) {
+  for (const std::string method : kMethods) {
+    Heuristics heuristics;
+    heuristics.Set("local_search", method);
+    LocalSearch search(graph);
+    for (size_t t = 0; t < kTours; ++t) {
+      std::vector<int> path(graph.Size());
+      std::iota(path.begin(), path.end(), 0);
+      std::shuffle(path.begin(), path.end(), random);
+      path.push_back(path.front());
+      const int start = path.front();
+      const long long before = TourLength(graph, path.data(), path.size());
+      search.Improve(path.data(), path.size(), heuristics.local_search);
+      const long long after = TourLength(graph, path.data(), path.size());
+      if (after < 0 or path.front() != start or after > before) {
+        std::cerr << name << ", " << method << ": tour " << t
+                  << " is broken or longer after local search\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Improves the tours of ants and checks that the lengths they cache
+ * match their paths.
+ */
+bool CheckAntTours(const Graph &graph, const std::string &name) {
+  const size_t vertex_cnt = graph.Size();
+  Ant::ChoiceInfo choice_info(vertex_cnt, vertex_cnt, 1.0);
+  std::vector<int> path(vertex_cnt + 1);
+  std::vector<uint64_t> tabu((vertex_cnt + 63) / 64);
+  for (const std::string method : kMethods) {
+    Heuristics heuristics;
+    heuristics.Set("local_search", method);
+    LocalSearch search(graph);
+    for (size_t t = 0; t < kTours; ++t) {
+      Ant ant(graph, path.data(), tabu.data());
+      ant.Reset(t % vertex_cnt, t);
+      ant.MakeBypass(choice_info);
+      const double before = ant.GetDistance();
+      ant.ImprovePath(search, heuristics.local_search);
+      const long long after =
+          TourLength(graph, ant.GetPath(), ant.GetPathSize());
+      if (after < 0 or after != ant.GetDistance() or after > before) {
+        std::cerr << name << ", " << method << ": ant " << t
+                  << " has a broken tour or a wrong length\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Solves the graph with every method through the parameters and
+ * checks the reported tour and its length.
+ */
+bool CheckRuns(const Graph &graph, const std::string &name) {
+  for (const std::string method : kMethods) {
+    for (const std::string scope : {"ant", "best"}) {
+      Heuristics heuristics;
+      heuristics.Set("colonies", "2");
+      heuristics.Set("local_search", method);
+      heuristics.Set("local_search_scope", scope);
+      AntAlgorithm algorithm(graph);
+      algorithm.SetHeuristics(heuristics);
+      algorithm.SetSeed(1);
+      algorithm.RunAlgorithm();
+      TsmResult result = algorithm.GetResult();
+      for (int &vertex : result.vertices) {
+        --vertex;
+      }
+      const long long length = TourLength(graph, result.vertices.data(),
+                                          result.vertices.size());
+      if (length < 0 or length != result.distance) {
+        std::cerr << name << ", " << method << ", " << scope
+                  << ": the result is not a tour of the reported length\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Checks that local search keeps tours valid and their lengths
+ * consistent, on a matrix graph and on a coordinate graph.
+ */
+int main() {
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::string matrix = (dir / "ant_local_search_matrix.txt").string();
+  const std::string points = (dir / "ant_local_search_points.tsp").string();
+  Random random(1);
+  WriteMatrixGraph(matrix, random);
+  WriteCoordinateGraph(points, random);
+
+  bool ok = true;
+  for (const std::string &file : {matrix, points}) {
+    Graph graph;
+    graph.LoadGraphFromFile(file);
+    ok = ok and CheckRandomTours(graph, file, random) and
+         (graph.HasCoordinates() or CheckAntTours(graph, file)) and
+         CheckRuns(graph, file);
+  }
+  std::filesystem::remove(matrix);
+  std::filesystem::remove(points);
+  return ok ? 0 : 1;
+}
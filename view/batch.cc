@@ -0,0 +1,349 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Loads the parameters and starts the worker pool.
+ *
+ * @param options Parsed command line options.
+ */
+Batch::Batch(const Options &options)
+    : options_{options}, parallelism_{Parallelism::kNone}, failed_{0} {
+  if (!options_.parameters.empty()) {
+    heuristics_ = Heuristics::LoadFromFile(options_.parameters);
+  }
+  for (const auto &setting : options_.settings) {
+    const size_t eq = setting.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("Setting without '=': " + setting);
+    }
+    heuristics_.Set(setting.substr(0, eq), setting.substr(eq + 1));
+  }
+  if (options_.time_limit > 0.0) heuristics_.time_limit = options_.time_limit;
+  heuristics_.Validate();
+
+  if (options_.mode == "serial") {
+    parallelism_ = Parallelism::kNone;
+  } else if (options_.mode == "ants") {
+    parallelism_ = Parallelism::kAnts;
+  } else if (options_.mode == "colonies") {
+    parallelism_ = Parallelism::kColonies;
+  } else if (options_.mode == "islands") {
+    parallelism_ = Parallelism::kIslands;
+  } else {
+    throw std::invalid_argument("Unknown mode " + options_.mode);
+  }
+  pool_ = options_.threads ? std::make_shared<ThreadPool>(options_.threads)
+                           : std::make_shared<ThreadPool>();
+}
+
+/**
+ * @brief Entry point of the batch mode: parses the arguments, solves the
+ * graphs and reports errors of the whole batch to stderr.
+ *
+ * @return 0 if every graph is solved, 1 if some are not, 2 on bad arguments
+ * or input.
+ */
+int Batch::Main(int argc, char *argv[]) {
+  try {
+    const Options options = ParseArguments(argc, argv);
+    if (options.help) {
+      PrintUsage(std::cout);
+      return 0;
+    }
+    Batch batch(options);
+    return batch.Run();
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n\n";
+    PrintUsage(std::cerr);
+    return 2;
+  }
+}
+
+/**
+ * @brief Parses command line options. Arguments that are not options are
+ * graph files, directories of graph files or "-" for a list of files on
+ * standard input.
+ *
+ * @return Options
+ */
+Batch::Options Batch::ParseArguments(int argc, char *argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help") {
+      options.help = true;
+      continue;
+    }
+    if (key == "--no-tours") {
+      options.tours = false;
+      continue;
+    }
+    if (key == "-" or key.compare(0, 2, "--") != 0) {
+      options.inputs.push_back(key);
+      continue;
+    }
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + key);
+    const std::string value = argv[++i];
+    if (key == "--params") {
+      options.parameters = value;
+    } else if (key == "--set") {
+      options.settings.push_back(value);
+    } else if (key == "--threads") {
+      options.threads = std::stoul(value);
+    } else if (key == "--mode") {
+      options.mode = value;
+    } else if (key == "--seed") {
+      options.seed = std::stoull(value);
+      options.has_seed = true;
+    } else if (key == "--time-limit") {
+      options.time_limit = std::stod(value);
+    } else if (key == "--format") {
+      options.format = value;
+    } else if (key == "--output") {
+      options.output = value;
+    } else {
+      throw std::invalid_argument("Unknown option " + key);
+    }
+  }
+  if (options.format != "json" and options.format != "csv") {
+    throw std::invalid_argument("Unknown format " + options.format);
+  }
+  if (options.inputs.empty() and !options.help) {
+    throw std::invalid_argument("No graph files given");
+  }
+  return options;
+}
+
+void Batch::PrintUsage(std::ostream &out) {
+  out << "Usage: Ant [options] <graph|directory|-> ...\n"
+         "Without arguments, starts the interactive menu. Otherwise solves "
+         "the given graphs\nconcurrently on one worker pool and writes one "
+         "result per line as they finish.\n"
+         "A directory stands for the files in it, '-' for file names read "
+         "from stdin.\n\n"
+         "  --params FILE      parameters file of key = value lines\n"
+         "  --set KEY=VALUE    override one parameter, repeatable\n"
+         "  --threads N        pool threads, all cores by default\n"
+         "  --mode MODE        parallelism within a graph: serial (default), "
+         "ants,\n"
+         "                     colonies or islands\n"
+         "  --seed N           seed of every graph, random by default\n"
+         "  --time-limit S     time budget of every graph in seconds\n"
+         "  --format FORMAT    json (JSON lines, default) or csv\n"
+         "  --output FILE      write results to FILE instead of stdout\n"
+         "  --no-tours         leave tours out of the results\n"
+         "  --help             show this help\n";
+}
+
+/**
+ * @brief Solves all graphs, each as one chunk of a parallel loop over the
+ * list, so free pool threads pick the next graph.
+ *
+ * @return 0 if every graph is solved, 1 otherwise.
+ */
+int Batch::Run() {
+  const std::vector<std::string> files = CollectFiles();
+  if (files.empty()) throw std::invalid_argument("No graph files found");
+
+  std::ofstream file_out;
+  if (!options_.output.empty()) {
+    file_out.open(options_.output);
+    if (!file_out) {
+      throw std::runtime_error("Cannot open output file " + options_.output);
+    }
+  }
+  std::ostream &out = options_.output.empty() ? std::cout : file_out;
+  if (options_.format == "csv") {
+    out << "index,file,size,distance,lower_bound,gap,time,error"
+        << (options_.tours ? ",tour" : "") << std::endl;
+  }
+
+  failed_ = 0;
+  pool_->ParallelFor(
+      files.size(),
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          Write(out, Solve(i, files[i]));
+        }
+      },
+      1);
+  return failed_ ? 1 : 0;
+}
+
+/**
+ * @brief Expands the inputs into the list of graph files. Files of a
+ * directory are taken in name order, hidden files and subdirectories are
+ * skipped.
+ *
+ * @return std::vector<std::string>
+ */
+std::vector<std::string> Batch::CollectFiles() const {
+  namespace fs = std::filesystem;
+  std::vector<std::string> files;
+  for (const auto &input : options_.inputs) {
+    if (input == "-") {
+      std::string line;
+      while (std::getline(std::cin, line)) {
+        if (!line.empty()) files.push_back(line);
+      }
+    } else if (fs::is_directory(input)) {
+      std::vector<std::string> entries;
+      for (const auto &entry : fs::directory_iterator(input)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() and name[0] != '.') {
+          entries.push_back(entry.path().string());
+        }
+      }
+      std::sort(entries.begin(), entries.end());
+      files.insert(files.end(), entries.begin(), entries.end());
+    } else {
+      files.push_back(input);
+    }
+  }
+  return files;
+}
+
+/**
+ * @brief Loads and solves one graph. Errors are reported in the outcome
+ * instead of ending the batch.
+ *
+ * @param index Position of the graph in the list.
+ * @param file Path to the graph file.
+ * @return Outcome
+ */
+Batch::Outcome Batch::Solve(size_t index, const std::string &file) {
+  Outcome outcome;
+  outcome.index = index;
+  outcome.file = file;
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    Graph graph;
+    graph.LoadGraphFromFile(file, pool_.get());
+    graph.ExtendCandidateLists(heuristics_.candidates);
+    outcome.size = graph.Size();
+    AntAlgorithm algorithm(graph, pool_);
+    algorithm.SetHeuristics(heuristics_);
+    algorithm.SetParallelism(parallelism_);
+    if (options_.has_seed) algorithm.SetSeed(options_.seed);
+    algorithm.RunAlgorithm();
+    outcome.result = algorithm.GetResult();
+  } catch (const std::exception &e) {
+    outcome.error = e.what();
+  }
+  outcome.time = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  return outcome;
+}
+
+/**
+ * @brief Writes the line of one graph and flushes it, so results can be
+ * consumed while the batch runs.
+ *
+ * @param out Output stream shared by all threads.
+ * @param outcome The outcome of the graph.
+ */
+void Batch::Write(std::ostream &out, const Outcome &outcome) {
+  const std::string line =
+      options_.format == "csv" ? ToCsv(outcome) : ToJson(outcome);
+  std::lock_guard<std::mutex> lock(output_mtx_);
+  if (!outcome.error.empty()) ++failed_;
+  out << line << std::endl;
+}
+
+std::string Batch::ToJson(const Outcome &outcome) const {
+  std::ostringstream line;
+  line << "{\"index\": " << outcome.index << ", \"file\": \""
+       << Escape(outcome.file) << "\", \"size\": " << outcome.size;
+  if (!outcome.error.empty()) {
+    line << ", \"error\": \"" << Escape(outcome.error) << "\"";
+  } else {
+    const TsmResult &result = outcome.result;
+    line << ", \"distance\": " << Number(result.distance)
+         << ", \"lower_bound\": "
+         << (result.lower_bound > 0.0 ? Number(result.lower_bound) : "null")
+         << ", \"gap\": " << Number(result.gap);
+  }
+  line << ", \"time\": " << Number(outcome.time);
+  if (options_.tours and outcome.error.empty()) {
+    line << ", \"tour\": [";
+    for (size_t i = 0; i < outcome.result.vertices.size(); ++i) {
+      line << (i ? ", " : "") << outcome.result.vertices[i];
+    }
+    line << "]";
+  }
+  line << "}";
+  return line.str();
+}
+
+std::string Batch::ToCsv(const Outcome &outcome) const {
+  const auto quote = [](const std::string &str) {
+    std::string quoted = "\"";
+    for (const char c : str) {
+      quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    }
+    return quoted + "\"";
+  };
+  const auto field = [](const std::string &value) {
+    return value == "null" ? std::string() : value;
+  };
+  const TsmResult &result = outcome.result;
+  const bool solved = outcome.error.empty();
+  std::ostringstream line;
+  line << outcome.index << ',' << quote(outcome.file) << ',' << outcome.size
+       << ',' << (solved ? Number(result.distance) : "") << ','
+       << (result.lower_bound > 0.0 ? Number(result.lower_bound) : "") << ','
+       << (solved ? field(Number(result.gap)) : "") << ','
+       << Number(outcome.time) << ','
+       << (solved ? "" : quote(outcome.error));
+  if (options_.tours) {
+    line << ',';
+    for (size_t i = 0; i < result.vertices.size(); ++i) {
+      line << (i ? " " : "") << result.vertices[i];
+    }
+  }
+  return line.str();
+}
+
+/**
+ * @brief Escapes a string for a JSON string literal.
+ *
+ * @return std::string
+ */
+std::string Batch::Escape(const std::string &str) {
+  std::string escaped;
+  for (const char c : str) {
+    if (c == '"' or c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", c);
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Formats a number for JSON, with null for infinity and NaN.
+ *
+ * @return std::string
+ */
+std::string Batch::Number(double value) {
+  if (!std::isfinite(value)) return "null";
+  std::ostringstream out;
+  out.precision(10);
+  out << value;
+  return out.str();
+}
@@ -0,0 +1,83 @@
+#ifndef SRC_VIEW_BATCH_H
+#define SRC_VIEW_BATCH_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../model/ant_algorithm.h"
+#include "../model/graph.h"
+#include "../model/heuristics.h"
+#include "../model/thread_pool.h"
+
+/**
+ * @brief Non-interactive front end: solves a list of graph files on one
+ * shared worker pool and streams one result line per graph, in the order the
+ * graphs are finished.
+ *
+ * Graphs are taken from the list by the pool threads as they become free, so
+ * several graphs are solved concurrently; a graph's own parallelism mode
+ * (serial by default) runs nested on the same pool.
+ */
+class Batch {
+ public:
+  struct Options {
+    std::vector<std::string> inputs;
+    std::string parameters;
+    std::vector<std::string> settings;
+    size_t threads = 0;
+    std::string mode = "serial";
+    bool has_seed = false;
+    uint64_t seed = 0;
+    double time_limit = 0.0;
+    std::string format = "json";
+    std::string output;
+    bool tours = true;
+    bool help = false;
+  };
+
+ public:
+  explicit Batch(const Options& options);
+
+  Batch(const Batch& other) = delete;
+  Batch(Batch&& other) = delete;
+  Batch& operator=(const Batch& other) = delete;
+  Batch& operator=(Batch&& other) = delete;
+
+ public:
+  static int Main(int argc, char* argv[]);
+  static Options ParseArguments(int argc, char* argv[]);
+  static void PrintUsage(std::ostream& out);
+  int Run();
+
+ private:
+  struct Outcome {
+    size_t index;
+    std::string file;
+    size_t size = 0;
+    TsmResult result;
+    double time = 0.0;
+    std::string error;
+  };
+
+  std::vector<std::string> CollectFiles() const;
+  Outcome Solve(size_t index, const std::string& file);
+  void Write(std::ostream& out, const Outcome& outcome);
+  std::string ToJson(const Outcome& outcome) const;
+  std::string ToCsv(const Outcome& outcome) const;
+  static std::string Escape(const std::string& str);
+  static std::string Number(double value);
+
+ private:
+  Options options_;
+  Heuristics heuristics_;
+  Parallelism parallelism_;
+  std::shared_ptr<ThreadPool> pool_;
+  std::mutex output_mtx_;
+  size_t failed_;
+};
+
+#endif  // SRC_VIEW_BATCH_H
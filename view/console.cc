@@ -12,6 +12,7 @@ const std::string Console::menu_{
       4. Solve the traveling salesman problem using\n \
          ant colony optimization with parallelism\n \
       5. Compare time of execution\n \
+      6. Load parameters from file\n \
       0. Exit\033[0m\n\u001b[46;1m                    \
                                         \u001b[0m\n\n"};
 
@@ -27,11 +28,13 @@ Console::Console() {
 
 void Console::FirstItem(const std::string &filename) {
   graph_.LoadGraphFromFile(filename);
+  graph_.ExtendCandidateLists(heuristics_.candidates);
 }
 
 std::pair<TsmResult, Console::Time> Console::ThirdItem() {
   std::vector<TsmResult> results;
   AntAlgorithm algo(graph_);
+  algo.SetHeuristics(heuristics_);
   algo.SetParallel(false);
   auto start = std::chrono::steady_clock::now();
   for (int i = 0; i < executions_; ++i) {
@@ -49,6 +52,7 @@ std::pair<TsmResult, Console::Time> Console::ThirdItem() {
 std::pair<TsmResult, Console::Time> Console::FourthItem() {
   std::vector<TsmResult> results;
   AntAlgorithm algo(graph_);
+  algo.SetHeuristics(heuristics_);
   algo.SetParallel(true);
   auto start = std::chrono::steady_clock::now();
   for (int i = 0; i < executions_; ++i) {
@@ -66,6 +70,7 @@ std::pair<TsmResult, Console::Time> Console::FourthItem() {
 std::pair<Console::Time, Console::Time> Console::FifthItem() {
   Time t1, t2;
   AntAlgorithm algo(graph_);
+  algo.SetHeuristics(heuristics_);
   algo.SetParallel(false);
   auto start = std::chrono::steady_clock::now();
   for (int i = 0; i < executions_; ++i) {
@@ -181,6 +186,10 @@ bool Console::ChooseMenuItem() {
                   << "\n\n";
       }
       break;
+    case 6:
+      system("clear");
+      InputParameters();
+      break;
     case 0:
       result = false;
       std::cout << GetColor(Color::kCyan) << Align("HOPE YOU ENJOY!👋")
@@ -231,6 +240,25 @@ void Console::InputFilename() {
   }
 }
 
+void Console::InputParameters() {
+  std::cout << GetColor(Color::kCyan)
+            << Align("ENTER PATH TO A PARAMETERS FILE:") << GetColor(Color::kEnd)
+            << "\n\n";
+  std::string file;
+  std::cin >> file;
+  system("clear");
+  try {
+    heuristics_ = Heuristics::LoadFromFile(file);
+    graph_.ExtendCandidateLists(heuristics_.candidates);
+    std::cout << GetColor(Color::kGreen) << Align("PARAMETERS LOADED")
+              << GetColor(Color::kEnd) << "\n\n";
+  } catch (const std::logic_error &e) {
+    std::cout << GetColor(Color::kRed) << Align(e.what())
+              << GetColor(Color::kEnd) << " 🚨"
+              << "\n\n";
+  }
+}
+
 void Console::Run() {
   system("clear");
   bool flag = true;
@@ -261,6 +289,12 @@ std::string Console::RouteToString(std::pair<TsmResult, Time> &tsm) {
   res +=
       Align("LENGTH: " + std::to_string(static_cast<int>(tsm.first.distance))) +
       "\n\n";
+  if (tsm.first.lower_bound > 0.0) {
+    res += Align("LOWER BOUND: " +
+                 std::to_string(static_cast<int>(tsm.first.lower_bound)) +
+                 " (GAP " + std::to_string(tsm.first.gap * 100.0) + "%)") +
+           "\n\n";
+  }
   res += Align("TIME: " + std::to_string(tsm.second.count()) + " SEC");
   return res;
 }
@@ -38,6 +38,7 @@ class Console {
   void PrintChosenFile();
   void PrintExecutions();
   void InputFilename();
+  void InputParameters();
   int InputNumber(const std::string& str);
   std::string Align(const std::string& str);
   std::string RouteToString(std::pair<TsmResult, Time>& tsm);
@@ -45,6 +46,7 @@ class Console {
 
  private:
   Graph graph_;
+  Heuristics heuristics_;
   std::string filename_{"./resources/graph_undirected.txt"};
   const static std::string menu_;
   int executions_{1};